@@ -0,0 +1,29 @@
+#!/bin/bash
+# 词法分析器差分测试：对语料中的每个 .c 文件运行 compiler -lex-diff，
+# 比较 flex 与手写词法分析器的 token 流，遇到第一个不一致的文件即失败。
+# 用法：scripts/lex_diff.sh [compiler] [语料目录...]
+# 默认 compiler 为 ./build/compiler，语料为仓库中的 tests/lex
+compiler=${1:-./build/compiler}
+shift
+dirs=("$@")
+[ ${#dirs[@]} -eq 0 ] && dirs=("$(dirname "$0")/../tests/lex")
+
+if [ ! -x "$compiler" ]; then
+    echo "lex_diff: $compiler 不存在或不可执行" >&2
+    exit 2
+fi
+
+count=0
+while IFS= read -r -d '' file; do
+    if ! "$compiler" -lex-diff "$file"; then
+        echo "lex_diff: FAIL $file（已通过 $count 个文件）" >&2
+        exit 1
+    fi
+    count=$((count + 1))
+done < <(find "${dirs[@]}" -name '*.c' -print0 | sort -z)
+
+if [ $count -eq 0 ]; then
+    echo "lex_diff: 在 ${dirs[*]} 中没有找到 .c 文件" >&2
+    exit 2
+fi
+echo "lex_diff: $count 个文件全部一致"
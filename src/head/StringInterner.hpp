@@ -0,0 +1,108 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 标识符编号：每个不同的标识符在词法分析时分配一个稠密的 32 位 ID，
+// 之后语法树和符号表都只保存/比较这个 ID，不再复制和哈希整个字符串
+using SymId = uint32_t;
+
+class StringInterner {
+public:
+    StringInterner() : slots(initial_slots, 0) {
+    }
+
+    // 查找或登记一个标识符，返回它的 ID
+    SymId intern(const char *text, size_t len) {
+        uint32_t h = hash(text, len);
+        size_t mask = slots.size() - 1;
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            uint32_t slot = slots[i];
+            if (slot == 0)
+                return insert(i, text, len, h);
+            const Entry &e = entries[slot - 1];
+            if (e.hash == h && e.len == len &&
+                std::memcmp(e.text, text, len) == 0)
+                return slot - 1;
+        }
+    }
+    SymId intern(const std::string &text) {
+        return intern(text.data(), text.size());
+    }
+
+    // 取回标识符的原文（以 '\0' 结尾，指针在整个编译过程中保持有效）
+    const char *str(SymId id) const {
+        return entries[id].text;
+    }
+    size_t length(SymId id) const {
+        return entries[id].len;
+    }
+    size_t size() const {
+        return entries.size();
+    }
+
+private:
+    struct Entry {
+        const char *text;
+        uint32_t len;
+        uint32_t hash;
+    };
+    static constexpr size_t initial_slots = 1024; // 必须是 2 的幂
+    static constexpr size_t chunk_size = 64 * 1024;
+
+    // FNV-1a
+    static uint32_t hash(const char *text, size_t len) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < len; i++) {
+            h ^= static_cast<unsigned char>(text[i]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    SymId insert(size_t slot, const char *text, size_t len, uint32_t h) {
+        SymId id = static_cast<SymId>(entries.size());
+        entries.push_back({store(text, len), static_cast<uint32_t>(len), h});
+        slots[slot] = id + 1;
+        if (entries.size() * 2 > slots.size())
+            rehash();
+        return id;
+    }
+
+    // 字符串按块存放，块只追加不移动，所以 str() 返回的指针始终有效
+    const char *store(const char *text, size_t len) {
+        if (chunks.empty() || chunk_used + len + 1 > chunk_cap) {
+            chunk_cap = std::max(chunk_size, len + 1);
+            chunks.emplace_back(new char[chunk_cap]);
+            chunk_used = 0;
+        }
+        char *dst = chunks.back().get() + chunk_used;
+        std::memcpy(dst, text, len);
+        dst[len] = '\0';
+        chunk_used += len + 1;
+        return dst;
+    }
+
+    void rehash() {
+        std::vector<uint32_t> grown(slots.size() * 2, 0);
+        size_t mask = grown.size() - 1;
+        for (size_t id = 0; id < entries.size(); id++) {
+            size_t i = entries[id].hash & mask;
+            while (grown[i] != 0)
+                i = (i + 1) & mask;
+            grown[i] = static_cast<uint32_t>(id + 1);
+        }
+        slots.swap(grown);
+    }
+
+    std::vector<uint32_t> slots; // 开放寻址表，存 ID + 1，0 表示空
+    std::vector<Entry> entries;  // 按 ID 索引
+    std::vector<std::unique_ptr<char[]>> chunks;
+    size_t chunk_used = 0;
+    size_t chunk_cap = 0;
+};
+
+extern StringInterner interner;
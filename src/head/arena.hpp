@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+// bump-pointer 内存池：按大块向系统申请，块内顺序分配，不支持单独释放，
+// release() 时整体归还。用于生命周期与一次编译相同的对象（语法树节点等）。
+class Arena {
+public:
+    explicit Arena(size_t block_size = 1 << 20) : block_size(block_size) {
+    }
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+    ~Arena() {
+        release();
+    }
+
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        total += size;
+        // 超大的请求单独占一块，不浪费当前块剩下的空间
+        if (size > block_size / 4)
+            return new_block(size);
+        size_t offset = (used + align - 1) & ~(align - 1);
+        if (!current || offset + size > block_size) {
+            current = new_block(block_size);
+            offset = 0;
+        }
+        used = offset + size;
+        return current + offset;
+    }
+
+    template <class T, class... Args> T *make(Args &&...args) {
+        return new (allocate(sizeof(T), alignof(T)))
+            T(std::forward<Args>(args)...);
+    }
+
+    // 一次性释放全部内存；其中对象的析构函数不会被调用
+    void release() {
+        for (char *block : blocks)
+            std::free(block);
+        blocks.clear();
+        current = nullptr;
+        used = total = 0;
+    }
+
+    size_t bytes_allocated() const {
+        return total;
+    }
+
+private:
+    char *new_block(size_t size) {
+        char *block = static_cast<char *>(std::malloc(size));
+        if (!block)
+            throw std::bad_alloc();
+        blocks.push_back(block);
+        return block;
+    }
+
+    size_t block_size;
+    std::vector<char *> blocks;
+    char *current = nullptr;
+    size_t used = 0;
+    size_t total = 0;
+};
+
+extern Arena ast_arena; // 语法树节点及其子节点数组所在的内存池
+
+// 让标准容器从 Arena 中分配，deallocate 为空操作
+template <class T> class ArenaAllocator {
+public:
+    using value_type = T;
+    ArenaAllocator(Arena *arena = &ast_arena) noexcept : arena(arena) {
+    }
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept
+        : arena(other.arena) {
+    }
+    T *allocate(size_t n) {
+        return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T *, size_t) noexcept {
+    }
+    template <class U> bool operator==(const ArenaAllocator<U> &o) const {
+        return arena == o.arena;
+    }
+    template <class U> bool operator!=(const ArenaAllocator<U> &o) const {
+        return arena != o.arena;
+    }
+
+    Arena *arena;
+};
@@ -0,0 +1,239 @@
+#include "cfg.hpp"
+#include <algorithm>
+
+// 从入口块出发的非递归深度优先遍历，按后序依次交给 visit。
+// 访问过的块在 IRBlock::id 中标为 0，其余为 -1
+template <class Visit> static void post_order(IRFunction *func, Visit visit) {
+    for (IRBlock *block : blocks(func))
+        block->id = -1;
+    struct Frame {
+        IRBlock *block;
+        uint32_t next_succ; // 下一个要访问的后继
+    };
+    std::vector<Frame> stack;
+    func->entry()->id = 0;
+    stack.push_back({func->entry(), 0});
+    while (!stack.empty()) {
+        Frame &top = stack.back();
+        IRInst *term = top.block->terminator();
+        if (term && top.next_succ < term->numTargets()) {
+            IRBlock *succ = term->targets[top.next_succ++];
+            if (succ->id < 0) {
+                succ->id = 0;
+                stack.push_back({succ, 0});
+            }
+            continue;
+        }
+        visit(top.block);
+        stack.pop_back();
+    }
+}
+
+int remove_unreachable_blocks(IRFunction *func) {
+    post_order(func, [](IRBlock *) {});
+    int removed = 0;
+    for (IRBlock *block : blocks(func)) {
+        if (block->id < 0) {
+            block->eraseFromParent();
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+IRInst *rebuild_branch(IRModule &module, IRInst *term,
+                       const std::vector<IRValue *> (&args)[2]) {
+    IRInst *replacement =
+        term->op == Opcode::BR
+            ? module.newBranch(term->operand(0), term->targets[0], args[0],
+                               term->targets[1], args[1])
+            : module.newJump(term->targets[0], args[0]);
+    term->parent->insertBefore(replacement, term);
+    term->eraseFromParent();
+    return replacement;
+}
+
+int forward_single_edge_args(IRFunction *func) {
+    // 数各块的入边，记下唯一的那条边（跳转指令及目标下标）
+    struct Edge {
+        int count = 0;
+        IRInst *term = nullptr;
+        uint32_t target = 0;
+    };
+    std::vector<Edge> edges;
+    int num_blocks = 0;
+    for (IRBlock *block : blocks(func))
+        block->id = num_blocks++;
+    edges.resize(num_blocks);
+    for (IRBlock *block : blocks(func)) {
+        IRInst *term = block->terminator();
+        for (uint32_t t = 0; term && t < term->numTargets(); ++t) {
+            Edge &edge = edges[term->targets[t]->id];
+            ++edge.count;
+            edge.term = term;
+            edge.target = t;
+        }
+    }
+    int forwarded = 0;
+    for (IRBlock *block : blocks(func)) {
+        const Edge &edge = edges[block->id];
+        if (edge.count != 1)
+            continue;
+        uint32_t begin = edge.term->targetArgBegin(edge.target);
+        for (uint32_t i = 0; i < block->num_args; ++i) {
+            IRValue *value = edge.term->operand(begin + i);
+            if (value == block->args[i] || !block->args[i]->hasUses())
+                continue;
+            block->args[i]->replaceAllUsesWith(value);
+            ++forwarded;
+        }
+    }
+    return forwarded;
+}
+
+int remove_block_args(IRModule &module, IRFunction *func,
+                      const std::function<bool(const IRBlockArg *)> &dead) {
+    // 先按原来的参数布局取出各跳转要保留的实参，
+    // 再压缩参数表，最后按新的布局重建跳转
+    struct Rewrite {
+        IRInst *term;
+        std::vector<IRValue *> args[2];
+    };
+    std::vector<Rewrite> rewrites;
+    for (IRBlock *block : blocks(func)) {
+        IRInst *term = block->terminator();
+        if (!term || !term->numTargets())
+            continue;
+        Rewrite rewrite{term, {}};
+        bool changed = false;
+        for (uint32_t t = 0; t < term->numTargets(); ++t) {
+            const IRBlock *target = term->targets[t];
+            uint32_t begin = term->targetArgBegin(t);
+            for (uint32_t i = 0; i < target->num_args; ++i) {
+                if (!dead(target->args[i]))
+                    rewrite.args[t].push_back(term->operand(begin + i));
+                else
+                    changed = true;
+            }
+        }
+        if (changed)
+            rewrites.push_back(std::move(rewrite));
+    }
+
+    int removed = 0;
+    for (IRBlock *block : blocks(func)) {
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < block->num_args; ++i) {
+            IRBlockArg *arg = block->args[i];
+            if (dead(arg))
+                continue;
+            arg->index = kept;
+            block->args[kept++] = arg;
+        }
+        removed += static_cast<int>(block->num_args - kept);
+        block->num_args = kept;
+    }
+    for (Rewrite &rewrite : rewrites)
+        rebuild_branch(module, rewrite.term, rewrite.args);
+    return removed;
+}
+
+int remove_unused_block_args(IRModule &module, IRFunction *func) {
+    return remove_block_args(module, func, [](const IRBlockArg *arg) {
+        return !arg->hasUses();
+    });
+}
+
+DominatorTree::DominatorTree(IRFunction *func) {
+    post_order(func, [this](IRBlock *block) { order.push_back(block); });
+    std::reverse(order.begin(), order.end());
+    size_t n = order.size();
+    for (size_t i = 0; i < n; ++i)
+        order[i]->id = static_cast<int>(i);
+
+    pred_lists.resize(n);
+    for (IRBlock *block : order) {
+        IRInst *term = block->terminator();
+        for (uint32_t t = 0; term && t < term->numTargets(); ++t) {
+            std::vector<IRBlock *> &preds = pred_lists[term->targets[t]->id];
+            if (preds.empty() || preds.back() != block)
+                preds.push_back(block);
+        }
+    }
+
+    // 按逆后序迭代到不动点。idom 未定的块记为 -1；
+    // 两个块的公共支配者沿 idom 向编号小的方向找
+    idoms.assign(n, -1);
+    idoms[0] = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < n; ++i) {
+            int new_idom = -1;
+            for (IRBlock *pred : pred_lists[i]) {
+                int p = pred->id;
+                if (idoms[p] < 0)
+                    continue;
+                if (new_idom < 0) {
+                    new_idom = p;
+                    continue;
+                }
+                while (p != new_idom) {
+                    while (p > new_idom)
+                        p = idoms[p];
+                    while (new_idom > p)
+                        new_idom = idoms[new_idom];
+                }
+            }
+            if (idoms[i] != new_idom) {
+                idoms[i] = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    child_lists.resize(n);
+    for (size_t i = 1; i < n; ++i)
+        child_lists[idoms[i]].push_back(order[i]);
+
+    // 非递归先序遍历支配树，记录进入与离开的时刻
+    enter.assign(n, 0);
+    leave.assign(n, 0);
+    int clock = 0;
+    std::vector<std::pair<int, size_t>> stack; // 结点、下一个子结点
+    enter[0] = clock++;
+    stack.push_back({0, 0});
+    while (!stack.empty()) {
+        auto &[node, next_child] = stack.back();
+        if (next_child < child_lists[node].size()) {
+            int child = child_lists[node][next_child++]->id;
+            enter[child] = clock++;
+            stack.push_back({child, 0});
+            continue;
+        }
+        leave[node] = clock++;
+        stack.pop_back();
+    }
+}
+
+std::vector<std::vector<IRBlock *>> DominatorTree::frontiers() const {
+    std::vector<std::vector<IRBlock *>> result(order.size());
+    for (IRBlock *block : order) {
+        const std::vector<IRBlock *> &preds = pred_lists[block->id];
+        if (preds.size() < 2)
+            continue;
+        // 从每个前驱沿支配树向上，直到 block 的直接支配者为止，
+        // 路过的块的支配边界都包含 block
+        for (IRBlock *pred : preds) {
+            int runner = pred->id;
+            while (runner != idoms[block->id]) {
+                std::vector<IRBlock *> &frontier = result[runner];
+                if (!frontier.empty() && frontier.back() == block)
+                    break; // 之前的前驱已经从这里走过
+                frontier.push_back(block);
+                runner = idoms[runner];
+            }
+        }
+    }
+    return result;
+}
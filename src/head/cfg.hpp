@@ -0,0 +1,66 @@
+#pragma once
+#include "ir.hpp"
+#include <functional>
+#include <vector>
+
+// 控制流图上的辅助分析，供各优化遍使用。
+// 后继就是终结指令的 targets，前驱在 DominatorTree 中按需计算。
+
+// 删除从入口块不可达的基本块，返回删除的个数。
+// 可达块的终结指令不会跳到它们，其中定义的值也只被它们自己使用
+int remove_unreachable_blocks(IRFunction *func);
+
+// 换掉 br / jump 传给目标块的实参（目标不变）：创建新的跳转指令
+// 代替 term，返回新指令。args[t] 是传给 targets[t] 的实参
+IRInst *rebuild_branch(IRModule &module, IRInst *term,
+                       const std::vector<IRValue *> (&args)[2]);
+
+// 只有一条入边的基本块，其参数总是等于那条边上的实参：把参数的使用
+// 换成实参（之后参数没有使用者，可以删除）。返回替换的参数个数
+int forward_single_edge_args(IRFunction *func);
+
+// 删除 dead 为真的基本块参数，同时去掉各跳转指令中对应的实参。
+// 这些参数只能被将被去掉的实参使用。返回删除的个数
+int remove_block_args(IRModule &module, IRFunction *func,
+                      const std::function<bool(const IRBlockArg *)> &dead);
+// 删除没有使用者的基本块参数
+int remove_unused_block_args(IRModule &module, IRFunction *func);
+
+// 支配树（Cooper、Harvey、Kennedy 的迭代算法）。
+// 可达的基本块按逆后序编号，编号存放在 IRBlock::id 中，不可达的块为 -1；
+// 构造之后在使用期间不能改变控制流，也不能有其他遍改写 IRBlock::id
+class DominatorTree {
+public:
+    explicit DominatorTree(IRFunction *func);
+
+    // 可达的基本块，按逆后序排列，入口块在最前面
+    const std::vector<IRBlock *> &blocks() const {
+        return order;
+    }
+    // 可达的前驱。一个前驱有两条边到达同一块时只出现一次
+    const std::vector<IRBlock *> &preds(const IRBlock *block) const {
+        return pred_lists[block->id];
+    }
+    // 直接支配者，入口块为空
+    IRBlock *idom(const IRBlock *block) const {
+        return block->id == 0 ? nullptr : order[idoms[block->id]];
+    }
+    // 支配树上的子结点
+    const std::vector<IRBlock *> &children(const IRBlock *block) const {
+        return child_lists[block->id];
+    }
+    // a 是否支配 b（包括 a == b）
+    bool dominates(const IRBlock *a, const IRBlock *b) const {
+        return enter[a->id] <= enter[b->id] && leave[b->id] <= leave[a->id];
+    }
+    // 每个块的支配边界，按块的编号索引
+    std::vector<std::vector<IRBlock *>> frontiers() const;
+
+private:
+    std::vector<IRBlock *> order;
+    std::vector<std::vector<IRBlock *>> pred_lists;
+    std::vector<std::vector<IRBlock *>> child_lists;
+    std::vector<int> idoms;
+    // 支配树先序遍历中进入、离开各结点的时刻，用来 O(1) 判断支配关系
+    std::vector<int> enter, leave;
+};
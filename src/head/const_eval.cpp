@@ -0,0 +1,109 @@
+#include "const_eval.hpp"
+#include <cassert>
+
+Opcode binary_opcode(BinaryOp op) {
+    switch (op) {
+    case BinaryOp::MUL:
+        return Opcode::MUL;
+    case BinaryOp::DIV:
+        return Opcode::DIV;
+    case BinaryOp::MOD:
+        return Opcode::MOD;
+    case BinaryOp::ADD:
+        return Opcode::ADD;
+    case BinaryOp::SUB:
+        return Opcode::SUB;
+    case BinaryOp::LT:
+        return Opcode::LT;
+    case BinaryOp::GT:
+        return Opcode::GT;
+    case BinaryOp::LE:
+        return Opcode::LE;
+    case BinaryOp::GE:
+        return Opcode::GE;
+    case BinaryOp::EQ:
+        return Opcode::EQ;
+    case BinaryOp::NE:
+        return Opcode::NE;
+    case BinaryOp::LAND:
+    case BinaryOp::LOR:
+        break;
+    }
+    assert(false && "&&/|| 没有对应的 IR 运算");
+    return Opcode::ADD;
+}
+
+std::optional<int> fold_unary(UnaryOp op, int operand) {
+    switch (op) {
+    case UnaryOp::POS:
+        return operand;
+    case UnaryOp::NEG:
+        return fold_binary(Opcode::SUB, 0, operand);
+    case UnaryOp::NOT:
+        return fold_binary(Opcode::EQ, 0, operand);
+    }
+    return std::nullopt;
+}
+
+std::optional<int> ConstFolder::evaluate(BaseAST *exp) {
+    walk(exp);
+    std::optional<int> value = values.back();
+    values.pop_back();
+    return value;
+}
+
+void ConstFolder::leaveBinaryExp(BinaryExpAST *node) {
+    std::optional<int> rhs = values.back();
+    values.pop_back();
+    std::optional<int> &lhs = values.back();
+    bool logical = node->op == BinaryOp::LAND || node->op == BinaryOp::LOR;
+    if (logical && lhs && (*lhs != 0) == (node->op == BinaryOp::LOR)) {
+        lhs = *lhs != 0; // 短路：右边不会求值，结果由左边决定
+    } else if (!lhs || !rhs) {
+        lhs.reset();
+    } else if (logical) {
+        lhs = *rhs != 0; // 左边没有短路，结果由右边决定
+    } else {
+        lhs = fold_binary(binary_opcode(node->op), *lhs, *rhs);
+    }
+}
+
+void ConstFolder::leaveUnaryOpExp(UnaryOpExpAST *node) {
+    std::optional<int> &operand = values.back();
+    if (operand)
+        operand = fold_unary(node->op, *operand);
+}
+
+void ConstFolder::leaveNumber(NumberAST *node) {
+    values.push_back(node->number);
+}
+
+bool ConstFolder::enterLVal(LValAST *node) {
+    // 只有已求出值的常量才参与求值，变量和参数在运行时才有值
+    const ConstDefAST *def = dyn_cast<ConstDefAST>(node->decl);
+    if (def && def->has_value)
+        values.push_back(def->value);
+    else
+        values.push_back(std::nullopt);
+    return false;
+}
+
+void ConstFolder::leaveCallExp(CallExpAST *node) {
+    if (node->func_rparams)
+        values.resize(values.size() -
+                      cast<FuncRParamsAST>(node->func_rparams.get())
+                          ->params.size());
+    values.push_back(std::nullopt);
+}
+
+bool ConstEvaluator::enterConstDef(ConstDefAST *node) {
+    std::optional<int> value = folder.evaluate(node->const_init_val.get());
+    node->has_value = value.has_value();
+    node->value = value.value_or(0);
+    return false;
+}
+
+void evaluate_constants(BaseAST *root) {
+    ConstEvaluator evaluator;
+    evaluator.walk(root);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "ir.hpp"
+#include "visitor.hpp"
+#include <optional>
+#include <vector>
+
+// 源码中的二元运算符对应的 IR 运算，折叠和生成指令都按它进行。
+// && 和 || 要短路求值，不是单条运算，不能传入
+Opcode binary_opcode(BinaryOp op);
+// 一元运算按生成的 IR（0 - x、0 == x）用 fold_binary 计算
+std::optional<int> fold_unary(UnaryOp op, int operand);
+
+// 对一棵表达式子树做编译期求值。后序遍历，操作数的值放在显式的值栈上。
+// 不是常量（含变量、调用、除零等）时返回 nullopt
+class ConstFolder : public ASTVisitor<ConstFolder> {
+public:
+    std::optional<int> evaluate(BaseAST *exp);
+
+    void leaveBinaryExp(BinaryExpAST *node);
+    void leaveUnaryOpExp(UnaryOpExpAST *node);
+    void leaveNumber(NumberAST *node);
+    bool enterLVal(LValAST *node);
+    void leaveCallExp(CallExpAST *node);
+
+private:
+    std::vector<std::optional<int>> values;
+};
+
+// 常量求值遍：在名字绑定之后运行，对每个 ConstDef 的初始值做编译期求值，
+// 结果缓存在 ConstDefAST::has_value / value 上，之后引用该常量的表达式
+// 直接读取缓存而不再重复求值。
+class ConstEvaluator : public ASTVisitor<ConstEvaluator> {
+public:
+    bool enterConstDef(ConstDefAST *node);
+    // 表达式里不会再有 ConstDef，不必进入
+    bool enterBinaryExp(BinaryExpAST *) {
+        return false;
+    }
+    bool enterUnaryOpExp(UnaryOpExpAST *) {
+        return false;
+    }
+    bool enterCallExp(CallExpAST *) {
+        return false;
+    }
+
+private:
+    ConstFolder folder;
+};
+
+void evaluate_constants(BaseAST *root);
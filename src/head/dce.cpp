@@ -0,0 +1,116 @@
+#include "dce.hpp"
+#include "cfg.hpp"
+#include <utility>
+#include <vector>
+
+// 可能在运行时出错的 div / mod 与 -O0 一样保留，判断与 fold_binary 相同
+static bool may_trap(const IRInst *inst) {
+    auto constant = [](const IRValue *value) -> std::optional<int32_t> {
+        if (const IRInteger *integer = dyn_cast<IRInteger>(value))
+            return integer->value;
+        return std::nullopt;
+    };
+    return inst->isBinary() && may_trap(inst->op, constant(inst->operand(0)),
+                                        constant(inst->operand(1)));
+}
+
+// 指令本身要求保留（不论结果是否被使用）
+static bool has_side_effects(const IRInst *inst) {
+    switch (inst->op) {
+    case Opcode::STORE:
+    case Opcode::BR:
+    case Opcode::JUMP:
+    case Opcode::RET:
+        return true;
+    case Opcode::CALL:
+        return !inst->callee->pure;
+    default: // 二元运算、alloc、load
+        return may_trap(inst);
+    }
+}
+
+int eliminate_dead_code(IRModule &module, IRFunction *func) {
+    if (func->isDeclaration())
+        return 0;
+    // 基本块参数和指令统一编号；同时记下每个块的入边（跳转指令、目标下标）
+    int num_values = 0, num_blocks = 0;
+    for (IRBlock *block : blocks(func)) {
+        block->id = num_blocks++;
+        for (uint32_t i = 0; i < block->num_args; ++i)
+            block->args[i]->id = num_values++;
+        for (IRInst *inst : insts(block))
+            inst->id = num_values++;
+    }
+    std::vector<std::vector<std::pair<IRInst *, uint32_t>>> in_edges(
+        num_blocks);
+    for (IRBlock *block : blocks(func)) {
+        IRInst *term = block->terminator();
+        for (uint32_t t = 0; term && t < term->numTargets(); ++t)
+            in_edges[term->targets[t]->id].push_back({term, t});
+    }
+
+    std::vector<bool> live(num_values, false);
+    std::vector<IRValue *> worklist;
+    auto mark = [&](IRValue *value) {
+        if (isa<IRInst>(value) || isa<IRBlockArg>(value)) {
+            if (!live[value->id]) {
+                live[value->id] = true;
+                worklist.push_back(value);
+            }
+        }
+    };
+    for (IRBlock *block : blocks(func))
+        for (IRInst *inst : insts(block))
+            if (has_side_effects(inst))
+                mark(inst);
+
+    while (!worklist.empty()) {
+        IRValue *value = worklist.back();
+        worklist.pop_back();
+        if (IRBlockArg *arg = dyn_cast<IRBlockArg>(value)) {
+            for (auto [term, t] : in_edges[arg->parent->id])
+                mark(term->operand(term->targetArgBegin(t) + arg->index));
+            continue;
+        }
+        IRInst *inst = cast<IRInst>(value);
+        // 跳转的实参随目标块参数是否活着而定，这里只标记 br 的条件
+        uint32_t num_operands = inst->op == Opcode::BR     ? 1
+                                : inst->op == Opcode::JUMP ? 0
+                                                           : inst->num_operands;
+        for (uint32_t i = 0; i < num_operands; ++i)
+            mark(inst->operand(i));
+    }
+
+    int removed = 0;
+    for (IRBlock *block : blocks(func)) {
+        for (IRInst *inst : insts(block)) {
+            if (!live[inst->id]) {
+                inst->eraseFromParent();
+                ++removed;
+            }
+        }
+    }
+    removed += remove_block_args(module, func, [&](const IRBlockArg *arg) {
+        return !live[arg->id];
+    });
+    return removed;
+}
+
+bool is_pure_function(IRFunction *func) {
+    if (func->isDeclaration())
+        return false; // 库函数都有 I/O 等副作用
+    for (IRBlock *block : blocks(func))
+        for (IRInst *inst : insts(block))
+            if ((inst->op == Opcode::CALL && !inst->callee->pure) ||
+                may_trap(inst))
+                return false; // 也包括递归调用自己：此时 pure 还是 false
+    // 有回边（目标支配跳转所在的块）就有循环
+    DominatorTree dom(func);
+    for (IRBlock *block : dom.blocks()) {
+        IRInst *term = block->terminator();
+        for (uint32_t t = 0; term && t < term->numTargets(); ++t)
+            if (dom.dominates(term->targets[t], block))
+                return false;
+    }
+    return true;
+}
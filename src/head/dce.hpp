@@ -0,0 +1,15 @@
+#pragma once
+#include "ir.hpp"
+
+// 死代码删除：从有副作用的指令（store、ret、跳转、调用非纯函数）出发，
+// 沿 def-use 反向标记活的值；基本块参数活着时，各前驱传给它的实参才活。
+// 没有标记到的指令和基本块参数一起删除，包括只在循环中互相传递的值。
+// 跳转指令和可能在运行时出错的 div / mod（见 ir.hpp 中的 may_trap）
+// 总是保留。返回删除的指令和基本块参数的个数
+int eliminate_dead_code(IRModule &module, IRFunction *func);
+
+// 判断函数是否没有副作用并且一定会正常返回：不调用库函数（I/O）或其他
+// 非纯函数，不递归，没有可能出错的除法，也没有循环（循环可能不终止，
+// 删除调用会改变程序行为）。store 只能写本函数的局部变量，不算副作用。
+// 被调函数的 IRFunction::pure 需要已经确定
+bool is_pure_function(IRFunction *func);
@@ -0,0 +1,310 @@
+#include "fast_lexer.hpp"
+#include "StringInterner.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#include <immintrin.h>
+#define FAST_LEXER_WIDTH 32
+#elif defined(__GNUC__) && defined(__SSE2__)
+#include <emmintrin.h>
+#define FAST_LEXER_WIDTH 16
+#endif
+
+namespace {
+
+inline bool is_space(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+inline bool is_word(unsigned char c) {
+    return unsigned((c | 0x20) - 'a') < 26u || unsigned(c - '0') < 10u ||
+           c == '_';
+}
+inline bool is_digit(unsigned char c) {
+    return unsigned(c - '0') < 10u;
+}
+inline bool is_octal(unsigned char c) {
+    return unsigned(c - '0') < 8u;
+}
+inline bool is_hex(unsigned char c) {
+    return unsigned(c - '0') < 10u || unsigned((c | 0x20) - 'a') < 6u;
+}
+
+#ifdef FAST_LEXER_WIDTH
+#if FAST_LEXER_WIDTH == 32
+using vec = __m256i;
+inline vec load(const char *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+inline vec splat(char c) {
+    return _mm256_set1_epi8(c);
+}
+inline vec eq(vec a, vec b) {
+    return _mm256_cmpeq_epi8(a, b);
+}
+inline vec bit_or(vec a, vec b) {
+    return _mm256_or_si256(a, b);
+}
+inline vec sub(vec a, vec b) {
+    return _mm256_sub_epi8(a, b);
+}
+inline vec min_u8(vec a, vec b) {
+    return _mm256_min_epu8(a, b);
+}
+inline uint32_t bits(vec v) {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(v));
+}
+#else
+using vec = __m128i;
+inline vec load(const char *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline vec splat(char c) {
+    return _mm_set1_epi8(c);
+}
+inline vec eq(vec a, vec b) {
+    return _mm_cmpeq_epi8(a, b);
+}
+inline vec bit_or(vec a, vec b) {
+    return _mm_or_si128(a, b);
+}
+inline vec sub(vec a, vec b) {
+    return _mm_sub_epi8(a, b);
+}
+inline vec min_u8(vec a, vec b) {
+    return _mm_min_epu8(a, b);
+}
+inline uint32_t bits(vec v) {
+    return static_cast<uint32_t>(_mm_movemask_epi8(v));
+}
+#endif
+constexpr uint32_t all_lanes =
+    FAST_LEXER_WIDTH == 32 ? 0xFFFFFFFFu : 0xFFFFu;
+
+// 无符号比较：lo <= v <= hi 的字节置为 0xFF
+inline vec in_range(vec v, char lo, char hi) {
+    vec d = sub(v, splat(lo));
+    return eq(min_u8(d, splat(static_cast<char>(hi - lo))), d);
+}
+inline vec space_lanes(vec v) {
+    return bit_or(bit_or(eq(v, splat(' ')), eq(v, splat('\t'))),
+                  bit_or(eq(v, splat('\n')), eq(v, splat('\r'))));
+}
+inline vec word_lanes(vec v) {
+    return bit_or(bit_or(in_range(bit_or(v, splat(0x20)), 'a', 'z'),
+                         in_range(v, '0', '9')),
+                  eq(v, splat('_')));
+}
+inline vec digit_lanes(vec v) {
+    return in_range(v, '0', '9');
+}
+
+// 跳过一段属于同一字符类的字节，返回第一个不属于该类的位置
+template <vec (*Lanes)(vec), bool (*Scalar)(unsigned char)>
+const char *skip_run(const char *p, const char *end) {
+    while (end - p >= FAST_LEXER_WIDTH) {
+        uint32_t miss = ~bits(Lanes(load(p))) & all_lanes;
+        if (miss)
+            return p + __builtin_ctz(miss);
+        p += FAST_LEXER_WIDTH;
+    }
+    while (p < end && Scalar(static_cast<unsigned char>(*p)))
+        p++;
+    return p;
+}
+
+// 找到第一个等于 c 的字节，找不到时返回 end
+const char *find_byte(const char *p, const char *end, char c) {
+    vec needle = splat(c);
+    while (end - p >= FAST_LEXER_WIDTH) {
+        uint32_t hit = bits(eq(load(p), needle));
+        if (hit)
+            return p + __builtin_ctz(hit);
+        p += FAST_LEXER_WIDTH;
+    }
+    while (p < end && *p != c)
+        p++;
+    return p;
+}
+
+inline const char *skip_space(const char *p, const char *end) {
+    return skip_run<space_lanes, is_space>(p, end);
+}
+inline const char *skip_word(const char *p, const char *end) {
+    return skip_run<word_lanes, is_word>(p, end);
+}
+inline const char *skip_digits(const char *p, const char *end) {
+    return skip_run<digit_lanes, is_digit>(p, end);
+}
+#else
+template <bool (*Scalar)(unsigned char)>
+const char *skip_run(const char *p, const char *end) {
+    while (p < end && Scalar(static_cast<unsigned char>(*p)))
+        p++;
+    return p;
+}
+const char *find_byte(const char *p, const char *end, char c) {
+    const void *hit = std::memchr(p, c, end - p);
+    return hit ? static_cast<const char *>(hit) : end;
+}
+inline const char *skip_space(const char *p, const char *end) {
+    return skip_run<is_space>(p, end);
+}
+inline const char *skip_word(const char *p, const char *end) {
+    return skip_run<is_word>(p, end);
+}
+inline const char *skip_digits(const char *p, const char *end) {
+    return skip_run<is_digit>(p, end);
+}
+#endif
+
+const char *skip_octal(const char *p, const char *end) {
+    while (p < end && is_octal(static_cast<unsigned char>(*p)))
+        p++;
+    return p;
+}
+const char *skip_hex(const char *p, const char *end) {
+    while (p < end && is_hex(static_cast<unsigned char>(*p)))
+        p++;
+    return p;
+}
+
+// 关键字表，与 sysy.l 中的规则一一对应
+int keyword(const char *p, size_t len) {
+    switch (len) {
+    case 2:
+        if (std::memcmp(p, "if", 2) == 0)
+            return IF;
+        break;
+    case 3:
+        if (std::memcmp(p, "int", 3) == 0)
+            return INT;
+        break;
+    case 4:
+        if (std::memcmp(p, "void", 4) == 0)
+            return VOID;
+        if (std::memcmp(p, "else", 4) == 0)
+            return ELSE;
+        break;
+    case 5:
+        if (std::memcmp(p, "const", 5) == 0)
+            return CONST;
+        if (std::memcmp(p, "while", 5) == 0)
+            return WHILE;
+        if (std::memcmp(p, "break", 5) == 0)
+            return BREAK;
+        break;
+    case 6:
+        if (std::memcmp(p, "return", 6) == 0)
+            return RETURN;
+        break;
+    case 8:
+        if (std::memcmp(p, "continue", 8) == 0)
+            return CONTINUE;
+        break;
+    }
+    return 0;
+}
+
+} // namespace
+
+int FastLexer::next(YYSTYPE &lval) {
+    for (;;) {
+        cur = skip_space(cur, limit);
+        if (cur == limit)
+            return 0;
+        if (cur[0] != '/' || limit - cur < 2)
+            break;
+        if (cur[1] == '/') { // LineComment: "//".*
+            cur = find_byte(cur + 2, limit, '\n');
+            continue;
+        }
+        if (cur[1] != '*')
+            break;
+        // MultiComment: 到第一个 "*/" 为止；没有闭合时和 flex 一样只吃掉 '/'
+        const char *p = cur + 2;
+        for (;;) {
+            p = find_byte(p, limit, '*');
+            if (p == limit || (limit - p >= 2 && p[1] == '/'))
+                break;
+            p++;
+        }
+        if (p == limit)
+            break;
+        cur = p + 2;
+    }
+
+    unsigned char c = static_cast<unsigned char>(*cur);
+    if (is_digit(c))
+        return scan_number(lval);
+    if (unsigned((c | 0x20) - 'a') < 26u || c == '_')
+        return scan_word(lval);
+
+    char second = limit - cur >= 2 ? cur[1] : '\0';
+    int two = 0;
+    switch (c) {
+    case '&':
+        two = second == '&' ? AND : 0;
+        break;
+    case '|':
+        two = second == '|' ? OR : 0;
+        break;
+    case '=':
+        two = second == '=' ? EQ : 0;
+        break;
+    case '!':
+        two = second == '=' ? NE : 0;
+        break;
+    case '<':
+        two = second == '=' ? LE : 0;
+        break;
+    case '>':
+        two = second == '=' ? GE : 0;
+        break;
+    }
+    if (two) {
+        cur += 2;
+        return two;
+    }
+    cur++;
+    if (c == '<')
+        return LT;
+    if (c == '>')
+        return GT;
+    return static_cast<char>(c); // 与 flex 的 "return yytext[0]" 一致
+}
+
+int FastLexer::scan_number(YYSTYPE &lval) {
+    const char *start = cur;
+    if (*cur != '0') { // Decimal: [1-9][0-9]*
+        cur = skip_digits(cur + 1, limit);
+    } else if (limit - cur >= 3 && (cur[1] | 0x20) == 'x' &&
+               is_hex(static_cast<unsigned char>(cur[2]))) {
+        cur = skip_hex(cur + 2, limit); // Hexadecimal: 0[xX][0-9a-fA-F]+
+    } else {
+        cur = skip_octal(cur + 1, limit); // Octal: 0[0-7]*
+    }
+    // 与 flex 规则一样用 strtol(…, 0) 求值，连溢出时的行为也保持一致
+    size_t len = cur - start;
+    char small[64];
+    if (len < sizeof(small)) {
+        std::memcpy(small, start, len);
+        small[len] = '\0';
+        lval.int_val = strtol(small, nullptr, 0);
+    } else {
+        lval.int_val = strtol(std::string(start, len).c_str(), nullptr, 0);
+    }
+    return INT_CONST;
+}
+
+int FastLexer::scan_word(YYSTYPE &lval) {
+    const char *start = cur;
+    cur = skip_word(cur + 1, limit);
+    size_t len = cur - start;
+    if (int kw = keyword(start, len))
+        return kw;
+    lval.sym_val = interner.intern(start, len);
+    return IDENT;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "sysy.tab.hpp"
+
+// 手写词法分析器，产生与 sysy.l 完全相同的 token 流（包括 yylval 的取值），
+// 供 Bison 生成的语法分析器直接使用。
+// 空白、注释、标识符和数字这类长串用 SIMD 一次判断 16/32 个字节：
+//   定义了 __AVX2__ 时用 AVX2，x86 上默认用 SSE2，其它平台退回逐字节扫描。
+class FastLexer {
+public:
+    // 在 [begin, end) 上扫描，调用方保证缓冲区在扫描期间有效
+    void reset(const char *begin, const char *end) {
+        cur = begin;
+        limit = end;
+    }
+    // 返回下一个 token，输入结束时返回 0
+    int next(YYSTYPE &lval);
+
+private:
+    int scan_number(YYSTYPE &lval);
+    int scan_word(YYSTYPE &lval);
+
+    const char *cur = nullptr;
+    const char *limit = nullptr;
+};
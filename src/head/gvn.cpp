@@ -0,0 +1,106 @@
+#include "gvn.hpp"
+#include "cfg.hpp"
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Expression {
+    Opcode op;
+    IRValue *lhs;
+    IRValue *rhs;
+    bool operator==(const Expression &o) const {
+        return op == o.op && lhs == o.lhs && rhs == o.rhs;
+    }
+};
+
+struct ExpressionHash {
+    size_t operator()(const Expression &e) const {
+        size_t h = std::hash<const void *>()(e.lhs);
+        h = h * 31 + std::hash<const void *>()(e.rhs);
+        return h * 31 + static_cast<size_t>(e.op);
+    }
+};
+
+bool is_commutative(Opcode op) {
+    switch (op) {
+    case Opcode::NE:
+    case Opcode::EQ:
+    case Opcode::ADD:
+    case Opcode::MUL:
+    case Opcode::AND:
+    case Opcode::OR:
+    case Opcode::XOR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 规范形式：a > b 写成 b < a，a >= b 写成 b <= a；
+// 可交换运算的操作数按地址排序（常量是唯一的对象，地址同样可比）
+Expression canonical(const IRInst *inst) {
+    Expression e{inst->op, inst->operand(0), inst->operand(1)};
+    if (e.op == Opcode::GT || e.op == Opcode::GE) {
+        e.op = e.op == Opcode::GT ? Opcode::LT : Opcode::LE;
+        std::swap(e.lhs, e.rhs);
+    } else if (is_commutative(e.op) && std::less<IRValue *>()(e.rhs, e.lhs)) {
+        std::swap(e.lhs, e.rhs);
+    }
+    return e;
+}
+
+} // namespace
+
+int number_values(IRFunction *func) {
+    if (func->isDeclaration())
+        return 0;
+    DominatorTree dom(func);
+    std::unordered_map<Expression, IRInst *, ExpressionHash> table;
+    std::vector<Expression> scope; // 按插入顺序，离开子树时从表中撤销
+    int removed = 0;
+
+    auto visit = [&](IRBlock *block) {
+        for (IRInst *inst : insts(block)) {
+            if (!inst->isBinary())
+                continue;
+            Expression e = canonical(inst);
+            auto [it, inserted] = table.emplace(e, inst);
+            if (inserted) {
+                scope.push_back(e);
+                continue;
+            }
+            inst->replaceAllUsesWith(it->second);
+            inst->eraseFromParent();
+            ++removed;
+        }
+    };
+
+    // 非递归先序遍历支配树
+    struct Frame {
+        IRBlock *block;
+        size_t scope_size;
+        size_t next_child;
+    };
+    std::vector<Frame> stack;
+    stack.push_back({func->entry(), scope.size(), 0});
+    visit(func->entry());
+    while (!stack.empty()) {
+        Frame &top = stack.back();
+        const std::vector<IRBlock *> &children = dom.children(top.block);
+        if (top.next_child < children.size()) {
+            IRBlock *child = children[top.next_child++];
+            stack.push_back({child, scope.size(), 0});
+            visit(child);
+            continue;
+        }
+        while (scope.size() > top.scope_size) {
+            table.erase(scope.back());
+            scope.pop_back();
+        }
+        stack.pop_back();
+    }
+    return removed;
+}
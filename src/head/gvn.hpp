@@ -0,0 +1,10 @@
+#pragma once
+#include "ir.hpp"
+
+// 基于支配树的全局值编号（公共子表达式删除）。
+// 沿支配树先序遍历，用按作用域撤销的散列表记录 (运算, 操作数) 到
+// 第一条计算它的指令：后面遇到相同的表达式时，那条指令一定支配当前指令，
+// 于是把当前指令的使用换成它并删除当前指令。只处理二元运算（没有副作用）；
+// 可交换的运算和互为镜像的比较（a < b 与 b > a）先规范化操作数顺序。
+// 每条指令只查一次散列表，时间与指令数成线性。返回删除的指令数
+int number_values(IRFunction *func);
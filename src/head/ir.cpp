@@ -0,0 +1,279 @@
+#include "ir.hpp"
+#include <climits>
+
+const char *opcode_name(Opcode op) {
+    static const char *const names[] = {
+        "ne",  "eq",  "gt",    "lt",   "ge",    "le",   "add",
+        "sub", "mul", "div",   "mod",  "and",   "or",   "xor",
+        "shl", "shr", "sar",   "alloc", "load", "store", "call",
+        "br",  "jump", "ret"};
+    return names[static_cast<int>(op)];
+}
+
+std::optional<int32_t> fold_binary(Opcode op, int32_t lhs, int32_t rhs) {
+    // 加减乘、左移按 32 位补码回绕，移位量只取低 5 位
+    uint32_t ul = static_cast<uint32_t>(lhs), ur = static_cast<uint32_t>(rhs);
+    switch (op) {
+    case Opcode::NE:
+        return lhs != rhs;
+    case Opcode::EQ:
+        return lhs == rhs;
+    case Opcode::GT:
+        return lhs > rhs;
+    case Opcode::LT:
+        return lhs < rhs;
+    case Opcode::GE:
+        return lhs >= rhs;
+    case Opcode::LE:
+        return lhs <= rhs;
+    case Opcode::ADD:
+        return static_cast<int32_t>(ul + ur);
+    case Opcode::SUB:
+        return static_cast<int32_t>(ul - ur);
+    case Opcode::MUL:
+        return static_cast<int32_t>(ul * ur);
+    case Opcode::DIV:
+    case Opcode::MOD:
+        if (may_trap(op, lhs, rhs))
+            return std::nullopt;
+        return op == Opcode::DIV ? lhs / rhs : lhs % rhs;
+    case Opcode::AND:
+        return lhs & rhs;
+    case Opcode::OR:
+        return lhs | rhs;
+    case Opcode::XOR:
+        return lhs ^ rhs;
+    case Opcode::SHL:
+        return static_cast<int32_t>(ul << (ur & 31));
+    case Opcode::SHR:
+        return static_cast<int32_t>(ul >> (ur & 31));
+    case Opcode::SAR:
+        return lhs >> (ur & 31);
+    default:
+        return std::nullopt;
+    }
+}
+
+bool may_trap(Opcode op, std::optional<int32_t> lhs,
+              std::optional<int32_t> rhs) {
+    if (op != Opcode::DIV && op != Opcode::MOD)
+        return false;
+    return !rhs || *rhs == 0 || (*rhs == -1 && (!lhs || *lhs == INT32_MIN));
+}
+
+void IRUse::set(IRValue *v) {
+    if (value) { // 从旧值的链表摘下
+        if (prev)
+            prev->next = next;
+        else
+            value->uses = next;
+        if (next)
+            next->prev = prev;
+    }
+    value = v;
+    prev = nullptr;
+    next = nullptr;
+    if (v) { // 插到新值链表的头部
+        next = v->uses;
+        if (next)
+            next->prev = this;
+        v->uses = this;
+    }
+}
+
+void IRValue::replaceAllUsesWith(IRValue *v) {
+    assert(v != this);
+    while (uses)
+        uses->set(v);
+}
+
+void IRInst::eraseFromParent() {
+    for (uint32_t i = 0; i < num_operands; ++i)
+        operands[i].set(nullptr);
+    if (prev)
+        prev->next = next;
+    else
+        parent->first = next;
+    if (next)
+        next->prev = prev;
+    else
+        parent->last = prev;
+    parent = nullptr;
+    prev = next = nullptr;
+}
+
+void IRBlock::eraseFromParent() {
+    for (IRInst *inst : insts(this))
+        for (uint32_t i = 0; i < inst->num_operands; ++i)
+            inst->operands[i].set(nullptr);
+    if (prev)
+        prev->next = next;
+    else
+        parent->first = next;
+    if (next)
+        next->prev = prev;
+    else
+        parent->last = prev;
+    parent = nullptr;
+    prev = next = nullptr;
+}
+
+void IRBlock::append(IRInst *inst) {
+    inst->parent = this;
+    inst->prev = last;
+    inst->next = nullptr;
+    if (last)
+        last->next = inst;
+    else
+        first = inst;
+    last = inst;
+}
+
+void IRBlock::insertBefore(IRInst *inst, IRInst *before) {
+    assert(before->parent == this);
+    inst->parent = this;
+    inst->prev = before->prev;
+    inst->next = before;
+    if (before->prev)
+        before->prev->next = inst;
+    else
+        first = inst;
+    before->prev = inst;
+}
+
+void IRFunction::append(IRBlock *block) {
+    block->parent = this;
+    block->prev = last;
+    block->next = nullptr;
+    if (last)
+        last->next = block;
+    else
+        first = block;
+    last = block;
+}
+
+IRModule::IRModule()
+    : i32_type(arena.make<IRType>(IRType::I32)),
+      unit_type(arena.make<IRType>(IRType::UNIT)) {
+}
+
+const IRType *IRModule::pointerType(const IRType *base) {
+    auto it = pointer_types.find(base);
+    if (it != pointer_types.end())
+        return it->second;
+    IRType *ty = arena.make<IRType>(IRType::POINTER);
+    ty->base = base;
+    pointer_types.emplace(base, ty);
+    return ty;
+}
+
+const IRType *
+IRModule::functionType(const std::vector<const IRType *> &params,
+                       const IRType *ret) {
+    // 以参数类型后接返回类型作为键
+    std::vector<const IRType *> key = params;
+    key.push_back(ret);
+    auto it = function_types.find(key);
+    if (it != function_types.end())
+        return it->second;
+    IRType *ty = arena.make<IRType>(IRType::FUNCTION);
+    ty->ret = ret;
+    ty->params = copyArray(params);
+    ty->num_params = static_cast<uint32_t>(params.size());
+    function_types.emplace(std::move(key), ty);
+    return ty;
+}
+
+IRInteger *IRModule::integer(int32_t value) {
+    auto it = integers.find(value);
+    if (it != integers.end())
+        return it->second;
+    IRInteger *constant = arena.make<IRInteger>(i32_type, value);
+    integers.emplace(value, constant);
+    return constant;
+}
+
+IRFunction *IRModule::addFunction(const char *name, const IRType *type) {
+    assert(type->kind == IRType::FUNCTION);
+    IRFunction *func = arena.make<IRFunction>(name, type);
+    std::vector<IRArgument *> args;
+    for (uint32_t i = 0; i < type->num_params; ++i)
+        args.push_back(arena.make<IRArgument>(type->params[i], i));
+    func->args = copyArray(args);
+    func->num_args = type->num_params;
+    funcs.push_back(func);
+    function_index.emplace(name, func);
+    return func;
+}
+
+IRFunction *IRModule::findFunction(std::string_view name) const {
+    auto it = function_index.find(name);
+    return it == function_index.end() ? nullptr : it->second;
+}
+
+IRBlock *IRModule::newBlock(const char *prefix, int label) {
+    return arena.make<IRBlock>(prefix, label);
+}
+
+IRBlockArg *IRModule::addBlockArg(IRBlock *block, const IRType *type) {
+    // 容量不够时翻倍，旧数组留在 arena 中
+    if (block->num_args == block->arg_capacity) {
+        uint32_t capacity = block->arg_capacity ? block->arg_capacity * 2 : 4;
+        IRBlockArg **args = static_cast<IRBlockArg **>(arena.allocate(
+            capacity * sizeof(IRBlockArg *), alignof(IRBlockArg *)));
+        std::copy(block->args, block->args + block->num_args, args);
+        block->args = args;
+        block->arg_capacity = capacity;
+    }
+    IRBlockArg *arg = arena.make<IRBlockArg>(type, block, block->num_args);
+    block->args[block->num_args++] = arg;
+    return arg;
+}
+
+IRInst *IRModule::newInst(Opcode op, const IRType *type,
+                          std::initializer_list<IRValue *> operands) {
+    return newInst(op, type, operands.begin(), operands.size());
+}
+
+IRInst *IRModule::newInst(Opcode op, const IRType *type,
+                          IRValue *const *operands, size_t num_operands) {
+    IRInst *inst = arena.make<IRInst>(op, type);
+    if (num_operands) {
+        IRUse *uses = static_cast<IRUse *>(
+            arena.allocate(num_operands * sizeof(IRUse), alignof(IRUse)));
+        for (size_t i = 0; i < num_operands; ++i) {
+            new (&uses[i]) IRUse();
+            uses[i].user = inst;
+            uses[i].set(operands[i]);
+        }
+        inst->operands = uses;
+        inst->num_operands = static_cast<uint32_t>(num_operands);
+    }
+    return inst;
+}
+
+IRInst *IRModule::newJump(IRBlock *target,
+                          const std::vector<IRValue *> &args) {
+    assert(args.size() == target->num_args);
+    IRInst *inst = newInst(Opcode::JUMP, unit_type, args.data(), args.size());
+    inst->targets[0] = target;
+    return inst;
+}
+
+IRInst *IRModule::newBranch(IRValue *cond, IRBlock *then_block,
+                            const std::vector<IRValue *> &then_args,
+                            IRBlock *else_block,
+                            const std::vector<IRValue *> &else_args) {
+    assert(then_args.size() == then_block->num_args &&
+           else_args.size() == else_block->num_args);
+    std::vector<IRValue *> operands;
+    operands.reserve(1 + then_args.size() + else_args.size());
+    operands.push_back(cond);
+    operands.insert(operands.end(), then_args.begin(), then_args.end());
+    operands.insert(operands.end(), else_args.begin(), else_args.end());
+    IRInst *inst =
+        newInst(Opcode::BR, unit_type, operands.data(), operands.size());
+    inst->targets[0] = then_block;
+    inst->targets[1] = else_block;
+    return inst;
+}
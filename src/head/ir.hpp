@@ -0,0 +1,370 @@
+#pragma once
+#include "arena.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 编译器自己的 SSA IR，取代 libkoopa 的只读 raw 结构，供优化遍原地改写。
+//   - 类型和整数常量由 IRModule 统一创建（hash-consing），同样的类型/常量
+//     只有一个对象，可以直接比较指针；
+//   - 每个值带一条侵入式使用链表（IRUse），替换、删除都是 O(1)；
+//   - 指令在基本块中、基本块在函数中都用侵入式双向链表串起来；
+//   - 不用 phi：基本块可以带参数（IRBlockArg），由跳转指令传入实参；
+//   - 所有对象都分配在 IRModule 的 arena 中，随模块一起释放，不单独析构，
+//     因此对象里不保存 arena 之外的堆内存。
+// ir_printer.hpp 把它输出为 Koopa IR 文本，koopa_to_riscv.hpp 把它翻译为
+// RISC-V 汇编。
+
+class IRValue;
+class IRInst;
+class IRBlock;
+class IRFunction;
+
+class IRType {
+public:
+    enum Kind : uint8_t { I32, UNIT, POINTER, FUNCTION };
+    Kind kind;
+    const IRType *base = nullptr;          // POINTER 指向的类型
+    const IRType *ret = nullptr;           // FUNCTION 的返回类型
+    const IRType *const *params = nullptr; // FUNCTION 的参数类型
+    uint32_t num_params = 0;
+
+    explicit IRType(Kind k) : kind(k) {
+    }
+    bool isUnit() const {
+        return kind == UNIT;
+    }
+};
+
+// 一次使用：user 的某个操作数引用了 value。
+// 挂在 value 的使用链表上，链表按插入的逆序排列
+struct IRUse {
+    IRValue *value = nullptr;
+    IRInst *user = nullptr;
+    IRUse *prev = nullptr;
+    IRUse *next = nullptr;
+
+    // 改为引用 v（可以为空），同时维护新旧两个值的使用链表
+    void set(IRValue *v);
+};
+
+enum class IRValueKind : uint8_t { INTEGER, ARGUMENT, BLOCK_ARG, INST };
+
+class IRValue {
+public:
+    const IRValueKind value_kind;
+    const IRType *type;
+    // 变量、参数在源程序中的名字，打印为 @name_N / %name_N；临时值为空
+    const char *name = nullptr;
+    IRUse *uses = nullptr; // 使用链表头
+    // 供各遍临时使用的编号（打印时的 %N、后端的栈偏移等），
+    // 使用者负责在使用前重新赋值
+    int id = -1;
+
+    IRValue(IRValueKind k, const IRType *ty) : value_kind(k), type(ty) {
+    }
+    bool hasUses() const {
+        return uses != nullptr;
+    }
+    // 把所有使用改为引用 v
+    void replaceAllUsesWith(IRValue *v);
+};
+
+class IRInteger : public IRValue {
+public:
+    const int32_t value;
+    IRInteger(const IRType *ty, int32_t v)
+        : IRValue(IRValueKind::INTEGER, ty), value(v) {
+    }
+    static bool classof(const IRValue *v) {
+        return v->value_kind == IRValueKind::INTEGER;
+    }
+};
+
+// 函数的第 index 个参数
+class IRArgument : public IRValue {
+public:
+    const uint32_t index;
+    IRArgument(const IRType *ty, uint32_t i)
+        : IRValue(IRValueKind::ARGUMENT, ty), index(i) {
+    }
+    static bool classof(const IRValue *v) {
+        return v->value_kind == IRValueKind::ARGUMENT;
+    }
+};
+
+// 基本块 parent 的第 index 个参数
+class IRBlockArg : public IRValue {
+public:
+    IRBlock *const parent;
+    uint32_t index; // 删除前面的参数时随之改变
+    IRBlockArg(const IRType *ty, IRBlock *p, uint32_t i)
+        : IRValue(IRValueKind::BLOCK_ARG, ty), parent(p), index(i) {
+    }
+    static bool classof(const IRValue *v) {
+        return v->value_kind == IRValueKind::BLOCK_ARG;
+    }
+};
+
+// 二元运算排在最前面，顺序与 Koopa 的二元运算符相同
+enum class Opcode : uint8_t {
+    NE,
+    EQ,
+    GT,
+    LT,
+    GE,
+    LE,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    MOD,
+    AND,
+    OR,
+    XOR,
+    SHL,
+    SHR,
+    SAR,
+    ALLOC, // 局部变量，结果是指向 i32 的指针
+    LOAD,  // 操作数：地址
+    STORE, // 操作数：值、地址
+    CALL,  // 操作数：实参，被调函数在 callee
+    BR,    // 操作数：条件、两个目标的实参，目标在 targets[0] / targets[1]
+    JUMP,  // 操作数：目标的实参，目标在 targets[0]
+    RET    // 操作数：返回值（可选）
+};
+const char *opcode_name(Opcode op); // Koopa 中的助记符
+// 按目标机器（RISC-V 32 位）语义计算二元运算。前端的常量求值、IR 生成
+// 和 SCCP 都用它折叠；可能在运行时出错的 div / mod 留到运行时，返回 nullopt
+std::optional<int32_t> fold_binary(Opcode op, int32_t lhs, int32_t rhs);
+// div / mod 是否可能在运行时出错（除零、INT_MIN / -1）。
+// 编译期不知道值的操作数传 nullopt。死代码删除据此保留这样的除法
+bool may_trap(Opcode op, std::optional<int32_t> lhs,
+              std::optional<int32_t> rhs);
+
+class IRInst : public IRValue {
+public:
+    const Opcode op;
+    IRBlock *parent = nullptr;
+    IRInst *prev = nullptr; // 基本块中的前后指令
+    IRInst *next = nullptr;
+    IRUse *operands = nullptr;
+    uint32_t num_operands = 0;
+    IRFunction *callee = nullptr;               // CALL
+    IRBlock *targets[2] = {nullptr, nullptr}; // BR / JUMP
+
+    IRInst(Opcode o, const IRType *ty) : IRValue(IRValueKind::INST, ty), op(o) {
+    }
+    static bool classof(const IRValue *v) {
+        return v->value_kind == IRValueKind::INST;
+    }
+
+    IRValue *operand(uint32_t i) const {
+        assert(i < num_operands);
+        return operands[i].value;
+    }
+    void setOperand(uint32_t i, IRValue *v) {
+        assert(i < num_operands);
+        operands[i].set(v);
+    }
+    bool isBinary() const {
+        return op <= Opcode::SAR;
+    }
+    bool isTerminator() const {
+        return op == Opcode::BR || op == Opcode::JUMP || op == Opcode::RET;
+    }
+    // br / jump 的目标个数
+    uint32_t numTargets() const {
+        return op == Opcode::BR ? 2 : op == Opcode::JUMP ? 1 : 0;
+    }
+    // 传给 targets[t] 的实参从这个操作数开始，个数等于目标块的参数个数
+    inline uint32_t targetArgBegin(uint32_t t) const;
+    // 从基本块中摘下并放弃对操作数的使用。指令本身的内存不回收
+    void eraseFromParent();
+};
+
+class IRBlock {
+public:
+    // 打印为 %prefix_label；label 为负时只打印 %prefix（如 %entry）
+    const char *prefix;
+    int label;
+    IRFunction *parent = nullptr;
+    IRBlock *prev = nullptr; // 函数中的前后基本块
+    IRBlock *next = nullptr;
+    IRInst *first = nullptr;
+    IRInst *last = nullptr;
+    IRBlockArg **args = nullptr; // 由 IRModule::addBlockArg 添加
+    uint32_t num_args = 0;
+    uint32_t arg_capacity = 0;
+    int id = -1; // 供各遍临时使用的编号，同 IRValue::id
+
+    IRBlock(const char *p, int l) : prefix(p), label(l) {
+    }
+    // 在末尾 / before 之前插入指令
+    void append(IRInst *inst);
+    void insertBefore(IRInst *inst, IRInst *before);
+    IRInst *terminator() const {
+        return last && last->isTerminator() ? last : nullptr;
+    }
+    // 从函数中摘下，并放弃其中所有指令对操作数的使用。
+    // 块中定义的值不能再有其他使用者
+    void eraseFromParent();
+};
+
+uint32_t IRInst::targetArgBegin(uint32_t t) const {
+    assert(t < numTargets());
+    return op == Opcode::BR ? 1 + (t ? targets[0]->num_args : 0) : 0;
+}
+
+class IRFunction {
+public:
+    const char *name; // 不含 '@'
+    const IRType *type;
+    IRArgument *const *args = nullptr;
+    uint32_t num_args = 0;
+    IRBlock *first = nullptr; // 没有基本块的是库函数声明
+    IRBlock *last = nullptr;
+    // 没有副作用并且一定会返回：结果不用的调用可以删除。由死代码删除遍设置
+    bool pure = false;
+
+    IRFunction(const char *n, const IRType *ty) : name(n), type(ty) {
+    }
+    bool isDeclaration() const {
+        return first == nullptr;
+    }
+    IRBlock *entry() const {
+        return first;
+    }
+    void append(IRBlock *block);
+};
+
+// 遍历链表的辅助函数：for (IRInst *inst : insts(block)) ...
+// 循环中可以删除当前元素（迭代前已经取得后继）
+template <class T> class IRListRange {
+public:
+    class iterator {
+    public:
+        explicit iterator(T *n) : node(n), succ(n ? n->next : nullptr) {
+        }
+        T *operator*() const {
+            return node;
+        }
+        iterator &operator++() {
+            node = succ;
+            succ = node ? node->next : nullptr;
+            return *this;
+        }
+        bool operator!=(const iterator &o) const {
+            return node != o.node;
+        }
+
+    private:
+        T *node, *succ;
+    };
+    explicit IRListRange(T *first) : head(first) {
+    }
+    iterator begin() const {
+        return iterator(head);
+    }
+    iterator end() const {
+        return iterator(nullptr);
+    }
+
+private:
+    T *head;
+};
+inline IRListRange<IRInst> insts(const IRBlock *block) {
+    return IRListRange<IRInst>(block->first);
+}
+inline IRListRange<IRBlock> blocks(const IRFunction *func) {
+    return IRListRange<IRBlock>(func->first);
+}
+
+// 一个编译单元。负责创建（并拥有）所有 IR 对象
+class IRModule {
+public:
+    IRModule();
+    IRModule(const IRModule &) = delete;
+    IRModule &operator=(const IRModule &) = delete;
+
+    // 类型
+    const IRType *i32Type() const {
+        return i32_type;
+    }
+    const IRType *unitType() const {
+        return unit_type;
+    }
+    const IRType *pointerType(const IRType *base);
+    const IRType *functionType(const std::vector<const IRType *> &params,
+                               const IRType *ret);
+
+    // 常量
+    IRInteger *integer(int32_t value);
+
+    // 函数按创建顺序排列；name 需在模块的生命周期内有效
+    IRFunction *addFunction(const char *name, const IRType *type);
+    IRFunction *findFunction(std::string_view name) const;
+    const std::vector<IRFunction *> &functions() const {
+        return funcs;
+    }
+
+    IRBlock *newBlock(const char *prefix, int label = -1);
+    // 给基本块追加一个参数。已有的跳转指令不会随之补上实参
+    IRBlockArg *addBlockArg(IRBlock *block, const IRType *type);
+    // 创建指令（尚未插入基本块），操作数按顺序给出
+    IRInst *newInst(Opcode op, const IRType *type,
+                    std::initializer_list<IRValue *> operands = {});
+    IRInst *newInst(Opcode op, const IRType *type, IRValue *const *operands,
+                    size_t num_operands);
+    // 跳转指令，实参个数与目标块的参数个数相同
+    IRInst *newJump(IRBlock *target, const std::vector<IRValue *> &args = {});
+    IRInst *newBranch(IRValue *cond, IRBlock *then_block,
+                      const std::vector<IRValue *> &then_args,
+                      IRBlock *else_block,
+                      const std::vector<IRValue *> &else_args);
+    // 在 arena 中复制一个数组
+    template <class T> T *copyArray(const std::vector<T> &items) {
+        if (items.empty())
+            return nullptr;
+        T *array = static_cast<T *>(
+            arena.allocate(items.size() * sizeof(T), alignof(T)));
+        std::copy(items.begin(), items.end(), array);
+        return array;
+    }
+
+    Arena arena;
+
+private:
+    const IRType *i32_type;
+    const IRType *unit_type;
+    std::unordered_map<const IRType *, const IRType *> pointer_types;
+    std::map<std::vector<const IRType *>, const IRType *> function_types;
+    std::unordered_map<int32_t, IRInteger *> integers;
+    std::vector<IRFunction *> funcs;
+    std::unordered_map<std::string_view, IRFunction *> function_index;
+};
+
+// IR 值的 isa/cast/dyn_cast，按各类的 classof 判断
+template <class T> bool isa(const IRValue *v) {
+    return T::classof(v);
+}
+template <class T> T *cast(IRValue *v) {
+    assert(isa<T>(v));
+    return static_cast<T *>(v);
+}
+template <class T> const T *cast(const IRValue *v) {
+    assert(isa<T>(v));
+    return static_cast<const T *>(v);
+}
+template <class T> T *dyn_cast(IRValue *v) {
+    return isa<T>(v) ? static_cast<T *>(v) : nullptr;
+}
+template <class T> const T *dyn_cast(const IRValue *v) {
+    return isa<T>(v) ? static_cast<const T *>(v) : nullptr;
+}
@@ -0,0 +1,548 @@
+#include "ir_binary.hpp"
+#include <cstring>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+// 写出时收集各段内容；记录都是定长的，最后按段顺序整体写出
+class KirWriter {
+public:
+    void run(IRModule &module, OutputBuffer &out);
+
+private:
+    uint32_t typeId(const IRType *ty);
+    uint32_t string(const char *str);
+    uint32_t valueId(const IRValue *value) const;
+    void collectConsts(const IRInst *inst);
+    KirInst instRecord(const IRInst *inst);
+    template <class T> static void writeSection(const std::vector<T> &items,
+                                                OutputBuffer &out) {
+        out.write(reinterpret_cast<const char *>(items.data()),
+                  items.size() * sizeof(T));
+    }
+
+    std::unordered_map<const IRType *, uint32_t> type_ids;
+    std::unordered_map<const IRValue *, uint32_t> const_ids;
+    std::unordered_map<const IRFunction *, uint32_t> func_ids;
+    std::unordered_map<std::string_view, uint32_t> string_ids;
+
+    std::vector<KirType> types;
+    std::vector<uint32_t> type_params;
+    std::vector<int32_t> consts;
+    std::vector<KirFunction> funcs;
+    std::vector<uint32_t> args;
+    std::vector<KirBlock> blocks;
+    std::vector<uint32_t> block_args;
+    std::vector<KirInst> insts;
+    std::vector<uint32_t> inst_args;
+    std::string strings;
+    uint32_t num_args = 0;
+    uint32_t num_block_args = 0;
+    uint32_t num_insts = 0;
+};
+
+uint32_t KirWriter::typeId(const IRType *ty) {
+    auto it = type_ids.find(ty);
+    if (it != type_ids.end())
+        return it->second;
+    // 先登记引用到的类型，保证它们排在前面
+    KirType rec{ty->kind, 0, 0, 0};
+    if (ty->kind == IRType::POINTER) {
+        rec.a = typeId(ty->base);
+    } else if (ty->kind == IRType::FUNCTION) {
+        rec.a = typeId(ty->ret);
+        std::vector<uint32_t> params;
+        for (uint32_t i = 0; i < ty->num_params; ++i)
+            params.push_back(typeId(ty->params[i]));
+        rec.b = static_cast<uint32_t>(type_params.size());
+        rec.c = ty->num_params;
+        type_params.insert(type_params.end(), params.begin(), params.end());
+    }
+    uint32_t id = static_cast<uint32_t>(types.size());
+    types.push_back(rec);
+    type_ids.emplace(ty, id);
+    return id;
+}
+
+uint32_t KirWriter::string(const char *str) {
+    if (!str)
+        return KIR_NONE;
+    auto it = string_ids.find(str);
+    if (it != string_ids.end())
+        return it->second;
+    uint32_t offset = static_cast<uint32_t>(strings.size());
+    strings.append(str);
+    strings.push_back('\0');
+    string_ids.emplace(str, offset);
+    return offset;
+}
+
+// 参数、基本块参数和指令的 id 在第一遍中分别按各自的段编号
+uint32_t KirWriter::valueId(const IRValue *value) const {
+    uint32_t num_consts = static_cast<uint32_t>(consts.size());
+    switch (value->value_kind) {
+    case IRValueKind::INTEGER:
+        return const_ids.at(value);
+    case IRValueKind::ARGUMENT:
+        return num_consts + value->id;
+    case IRValueKind::BLOCK_ARG:
+        return num_consts + num_args + value->id;
+    case IRValueKind::INST:
+        break;
+    }
+    return num_consts + num_args + num_block_args + value->id;
+}
+
+void KirWriter::collectConsts(const IRInst *inst) {
+    for (uint32_t i = 0; i < inst->num_operands; ++i) {
+        const IRInteger *constant = dyn_cast<IRInteger>(inst->operand(i));
+        if (constant && !const_ids.count(constant)) {
+            const_ids.emplace(constant, static_cast<uint32_t>(consts.size()));
+            consts.push_back(constant->value);
+        }
+    }
+}
+
+KirInst KirWriter::instRecord(const IRInst *inst) {
+    KirInst rec{};
+    rec.op = static_cast<uint8_t>(inst->op);
+    rec.type = typeId(inst->type);
+    rec.name = string(inst->name);
+    rec.a = rec.b = rec.c = rec.d = KIR_NONE;
+    switch (inst->op) {
+    case Opcode::ALLOC:
+        break;
+    case Opcode::CALL:
+        rec.a = func_ids.at(inst->callee);
+        rec.b = static_cast<uint32_t>(inst_args.size());
+        rec.c = inst->num_operands;
+        for (uint32_t i = 0; i < inst->num_operands; ++i)
+            inst_args.push_back(valueId(inst->operand(i)));
+        break;
+    case Opcode::BR:
+        rec.a = valueId(inst->operand(0));
+        rec.b = inst->targets[0]->id;
+        rec.c = inst->targets[1]->id;
+        rec.d = static_cast<uint32_t>(inst_args.size());
+        for (uint32_t i = 1; i < inst->num_operands; ++i)
+            inst_args.push_back(valueId(inst->operand(i)));
+        break;
+    case Opcode::JUMP:
+        rec.b = inst->targets[0]->id;
+        rec.d = static_cast<uint32_t>(inst_args.size());
+        for (uint32_t i = 0; i < inst->num_operands; ++i)
+            inst_args.push_back(valueId(inst->operand(i)));
+        break;
+    default: // 二元运算、load、store、ret
+        if (inst->num_operands > 0)
+            rec.a = valueId(inst->operand(0));
+        if (inst->num_operands > 1)
+            rec.b = valueId(inst->operand(1));
+        break;
+    }
+    return rec;
+}
+
+void KirWriter::run(IRModule &module, OutputBuffer &out) {
+    // 第一遍：编号参数、基本块及其参数和指令，收集常量
+    for (IRFunction *func : module.functions()) {
+        func_ids.emplace(func, static_cast<uint32_t>(func_ids.size()));
+        for (uint32_t i = 0; i < func->num_args; ++i)
+            func->args[i]->id = static_cast<int>(num_args++);
+        int block_id = 0;
+        for (IRBlock *block : ::blocks(func)) {
+            block->id = block_id++;
+            for (uint32_t i = 0; i < block->num_args; ++i)
+                block->args[i]->id = static_cast<int>(num_block_args++);
+            for (IRInst *inst : ::insts(block)) {
+                inst->id = static_cast<int>(num_insts++);
+                collectConsts(inst);
+            }
+        }
+    }
+
+    // 第二遍：生成各段记录
+    for (IRFunction *func : module.functions()) {
+        KirFunction rec{string(func->name), typeId(func->type),
+                        static_cast<uint32_t>(blocks.size()), 0};
+        for (uint32_t i = 0; i < func->num_args; ++i)
+            args.push_back(string(func->args[i]->name));
+        for (IRBlock *block : ::blocks(func)) {
+            KirBlock block_rec{string(block->prefix),
+                               block->label,
+                               static_cast<uint32_t>(block_args.size()),
+                               block->num_args,
+                               static_cast<uint32_t>(insts.size()),
+                               0};
+            for (uint32_t i = 0; i < block->num_args; ++i)
+                block_args.push_back(string(block->args[i]->name));
+            for (IRInst *inst : ::insts(block)) {
+                insts.push_back(instRecord(inst));
+                ++block_rec.num_insts;
+            }
+            blocks.push_back(block_rec);
+            ++rec.num_blocks;
+        }
+        funcs.push_back(rec);
+    }
+    while (strings.size() % 4)
+        strings.push_back('\0');
+
+    KirHeader header{};
+    std::memcpy(header.magic, KIR_MAGIC, sizeof header.magic);
+    header.version = KIR_VERSION;
+    header.num_types = static_cast<uint32_t>(types.size());
+    header.num_type_params = static_cast<uint32_t>(type_params.size());
+    header.num_consts = static_cast<uint32_t>(consts.size());
+    header.num_funcs = static_cast<uint32_t>(funcs.size());
+    header.num_args = num_args;
+    header.num_blocks = static_cast<uint32_t>(blocks.size());
+    header.num_block_args = num_block_args;
+    header.num_insts = num_insts;
+    header.num_inst_args = static_cast<uint32_t>(inst_args.size());
+    header.string_bytes = static_cast<uint32_t>(strings.size());
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof header);
+    writeSection(types, out);
+    writeSection(type_params, out);
+    writeSection(consts, out);
+    writeSection(funcs, out);
+    writeSection(args, out);
+    writeSection(blocks, out);
+    writeSection(block_args, out);
+    writeSection(insts, out);
+    writeSection(inst_args, out);
+    out.write(strings.data(), strings.size());
+}
+
+// 按段顺序切分文件内容，越界时 ok 置为 false
+class KirReader {
+public:
+    KirReader(const char *data, size_t size) : data(data), size(size) {
+    }
+    template <class T> const T *section(uint32_t count) {
+        size_t bytes = static_cast<size_t>(count) * sizeof(T);
+        if (bytes > size - offset) {
+            ok = false;
+            return nullptr;
+        }
+        const T *items = reinterpret_cast<const T *>(data + offset);
+        offset += bytes;
+        return items;
+    }
+
+    bool ok = true;
+
+private:
+    const char *data;
+    size_t size;
+    size_t offset = 0;
+};
+
+// 指令记录中直接给出的操作数个数，不含 inst_args 中的实参
+uint32_t fixed_operand_count(const KirInst &rec) {
+    switch (static_cast<Opcode>(rec.op)) {
+    case Opcode::ALLOC:
+    case Opcode::JUMP:
+    case Opcode::CALL:
+        return 0;
+    case Opcode::LOAD:
+    case Opcode::BR:
+        return 1;
+    case Opcode::RET:
+        return rec.a == KIR_NONE ? 0 : 1;
+    default: // 二元运算、store
+        return 2;
+    }
+}
+
+bool is_alloc(const IRValue *value) {
+    const IRInst *inst = dyn_cast<IRInst>(value);
+    return inst && inst->op == Opcode::ALLOC;
+}
+
+} // namespace
+
+void write_kir(IRModule &module, OutputBuffer &out) {
+    KirWriter().run(module, out);
+}
+
+bool read_kir(const SourceBuffer &file, IRModule &module) {
+    KirReader reader(file.data(), file.size());
+    const KirHeader *header = reader.section<KirHeader>(1);
+    if (!header || std::memcmp(header->magic, KIR_MAGIC, 4) != 0 ||
+        header->version != KIR_VERSION)
+        return false;
+    const KirType *type_recs = reader.section<KirType>(header->num_types);
+    const uint32_t *type_params =
+        reader.section<uint32_t>(header->num_type_params);
+    const int32_t *const_recs = reader.section<int32_t>(header->num_consts);
+    const KirFunction *func_recs =
+        reader.section<KirFunction>(header->num_funcs);
+    const uint32_t *arg_names = reader.section<uint32_t>(header->num_args);
+    const KirBlock *block_recs = reader.section<KirBlock>(header->num_blocks);
+    const uint32_t *block_arg_names =
+        reader.section<uint32_t>(header->num_block_args);
+    const KirInst *inst_recs = reader.section<KirInst>(header->num_insts);
+    const uint32_t *inst_args =
+        reader.section<uint32_t>(header->num_inst_args);
+    const char *strings = reader.section<char>(header->string_bytes);
+    if (!reader.ok)
+        return false;
+
+    // 字符串表以 '\0' 结尾，任何合法偏移处都是完整的字符串
+    uint32_t string_bytes = header->string_bytes;
+    if (string_bytes && strings[string_bytes - 1] != '\0')
+        return false;
+    bool ok = true;
+    auto str = [&](uint32_t offset) -> const char * {
+        if (offset == KIR_NONE)
+            return nullptr;
+        if (offset >= string_bytes) {
+            ok = false;
+            return nullptr;
+        }
+        return strings + offset;
+    };
+
+    // 类型：引用的类型排在前面
+    std::vector<const IRType *> types(header->num_types);
+    for (uint32_t i = 0; i < header->num_types; ++i) {
+        const KirType &rec = type_recs[i];
+        switch (rec.kind) {
+        case IRType::I32:
+            types[i] = module.i32Type();
+            break;
+        case IRType::UNIT:
+            types[i] = module.unitType();
+            break;
+        case IRType::POINTER:
+            if (rec.a >= i)
+                return false;
+            types[i] = module.pointerType(types[rec.a]);
+            break;
+        case IRType::FUNCTION: {
+            if (rec.a >= i || rec.b > header->num_type_params ||
+                rec.c > header->num_type_params - rec.b)
+                return false;
+            std::vector<const IRType *> params;
+            for (uint32_t k = 0; k < rec.c; ++k) {
+                if (type_params[rec.b + k] >= i)
+                    return false;
+                params.push_back(types[type_params[rec.b + k]]);
+            }
+            types[i] = module.functionType(params, types[rec.a]);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    auto type = [&](uint32_t id) -> const IRType * {
+        if (id >= types.size()) {
+            ok = false;
+            return module.unitType();
+        }
+        return types[id];
+    };
+
+    // 值编号：常量、参数、基本块参数、指令
+    size_t num_values = static_cast<size_t>(header->num_consts) +
+                        header->num_args + header->num_block_args +
+                        header->num_insts;
+    std::vector<IRValue *> values(num_values);
+    size_t value_count = 0;
+    for (uint32_t i = 0; i < header->num_consts; ++i)
+        values[value_count++] = module.integer(const_recs[i]);
+
+    // 函数与参数。基本块、基本块参数、指令和使用各自整块分配
+    IRBlock *blocks = static_cast<IRBlock *>(module.arena.allocate(
+        header->num_blocks * sizeof(IRBlock), alignof(IRBlock)));
+    IRBlockArg *block_args = static_cast<IRBlockArg *>(module.arena.allocate(
+        header->num_block_args * sizeof(IRBlockArg), alignof(IRBlockArg)));
+    IRBlockArg **block_arg_ptrs = static_cast<IRBlockArg **>(
+        module.arena.allocate(header->num_block_args * sizeof(IRBlockArg *),
+                              alignof(IRBlockArg *)));
+    IRInst *insts = static_cast<IRInst *>(module.arena.allocate(
+        header->num_insts * sizeof(IRInst), alignof(IRInst)));
+    std::vector<IRFunction *> funcs(header->num_funcs);
+    // 每个函数自己的参数、基本块参数和指令的值编号区间，操作数只能引用
+    // 常量或所在函数的值
+    struct ValueRange {
+        size_t begin, end;
+        bool contains(uint32_t id) const {
+            return id >= begin && id < end;
+        }
+    };
+    struct FuncValues {
+        ValueRange args, block_args, insts;
+    };
+    std::vector<FuncValues> func_values(header->num_funcs);
+    size_t inst_values = value_count + header->num_args +
+                         header->num_block_args;
+    uint32_t next_arg = 0, next_block = 0, next_block_arg = 0, next_inst = 0;
+    // 基本块参数排在所有函数参数之后
+    size_t block_arg_values = value_count + header->num_args;
+    for (uint32_t i = 0; i < header->num_funcs; ++i) {
+        const KirFunction &rec = func_recs[i];
+        const char *name = str(rec.name);
+        const IRType *func_type = type(rec.type);
+        if (!ok || !name || func_type->kind != IRType::FUNCTION ||
+            func_type->num_params > header->num_args - next_arg ||
+            rec.first_block != next_block ||
+            rec.num_blocks > header->num_blocks - next_block)
+            return false;
+        IRFunction *func = funcs[i] = module.addFunction(name, func_type);
+        FuncValues &own = func_values[i];
+        own.args = {value_count, value_count + func->num_args};
+        own.block_args.begin = block_arg_values + next_block_arg;
+        own.insts.begin = inst_values + next_inst;
+        for (uint32_t k = 0; k < func->num_args; ++k) {
+            func->args[k]->name = str(arg_names[next_arg++]);
+            values[value_count++] = func->args[k];
+        }
+        for (uint32_t k = 0; k < rec.num_blocks; ++k, ++next_block) {
+            const KirBlock &block_rec = block_recs[next_block];
+            const char *prefix = str(block_rec.prefix);
+            if (!prefix || block_rec.first_arg != next_block_arg ||
+                block_rec.num_args > header->num_block_args - next_block_arg ||
+                block_rec.first_inst != next_inst ||
+                block_rec.num_insts == 0 || // 至少有结尾的跳转或返回
+                block_rec.num_insts > header->num_insts - next_inst)
+                return false;
+            IRBlock *block =
+                new (&blocks[next_block]) IRBlock(prefix, block_rec.label);
+            block->args = block_arg_ptrs + next_block_arg;
+            block->num_args = block->arg_capacity = block_rec.num_args;
+            for (uint32_t j = 0; j < block_rec.num_args; ++j) {
+                IRBlockArg *arg = new (&block_args[next_block_arg])
+                    IRBlockArg(module.i32Type(), block, j);
+                arg->name = str(block_arg_names[next_block_arg]);
+                block->args[j] = arg;
+                values[block_arg_values + next_block_arg++] = arg;
+            }
+            func->append(block);
+            next_inst += block_rec.num_insts;
+        }
+        own.block_args.end = block_arg_values + next_block_arg;
+        own.insts.end = inst_values + next_inst;
+    }
+    if (!ok || next_arg != header->num_args ||
+        next_block != header->num_blocks ||
+        next_block_arg != header->num_block_args ||
+        next_inst != header->num_insts)
+        return false;
+    value_count += header->num_block_args;
+
+    // inst_args 中的每个实参恰好被一条指令使用
+    size_t num_uses = header->num_inst_args;
+    for (uint32_t i = 0; i < header->num_insts; ++i) {
+        if (inst_recs[i].op > static_cast<uint8_t>(Opcode::RET))
+            return false;
+        num_uses += fixed_operand_count(inst_recs[i]);
+        values[value_count++] = new (&insts[i]) IRInst(
+            static_cast<Opcode>(inst_recs[i].op), type(inst_recs[i].type));
+        insts[i].name = str(inst_recs[i].name);
+    }
+    if (!ok)
+        return false;
+
+    // 所有值都已创建，再连接操作数，前向引用也能解析
+    IRUse *uses = static_cast<IRUse *>(
+        module.arena.allocate(num_uses * sizeof(IRUse), alignof(IRUse)));
+    const FuncValues *own = nullptr; // 正在连接的函数
+    auto value = [&](uint32_t id) -> IRValue * {
+        if (id >= num_values ||
+            (id >= header->num_consts && !own->args.contains(id) &&
+             !own->block_args.contains(id) && !own->insts.contains(id))) {
+            ok = false;
+            return nullptr;
+        }
+        return values[id];
+    };
+    uint32_t inst_index = 0, next_inst_arg = 0;
+    for (uint32_t i = 0; i < header->num_funcs; ++i) {
+        const KirFunction &func_rec = func_recs[i];
+        own = &func_values[i];
+        IRBlock *func_blocks = blocks + func_rec.first_block;
+        auto target = [&](uint32_t id) -> IRBlock * {
+            if (id >= func_rec.num_blocks) {
+                ok = false;
+                return nullptr;
+            }
+            return &func_blocks[id];
+        };
+        for (uint32_t k = 0; k < func_rec.num_blocks; ++k) {
+            uint32_t num_insts = block_recs[func_rec.first_block + k].num_insts;
+            for (uint32_t n = 0; n < num_insts; ++n, ++inst_index) {
+                const KirInst &rec = inst_recs[inst_index];
+                IRInst *inst = &insts[inst_index];
+                // 恰好最后一条指令是跳转或返回
+                if (inst->isTerminator() != (n + 1 == num_insts))
+                    return false;
+                // 实参接在直接给出的操作数之后
+                uint32_t fixed = fixed_operand_count(rec);
+                uint32_t extra = 0, extra_begin = rec.d;
+                switch (inst->op) {
+                case Opcode::CALL:
+                    if (rec.a >= header->num_funcs)
+                        return false;
+                    inst->callee = funcs[rec.a];
+                    // 实参个数和结果类型与被调函数一致（void 函数的结果为 unit）
+                    if (rec.c != inst->callee->type->num_params ||
+                        inst->type != inst->callee->type->ret)
+                        return false;
+                    extra = rec.c;
+                    extra_begin = rec.b;
+                    break;
+                case Opcode::BR:
+                    inst->targets[0] = target(rec.b);
+                    inst->targets[1] = target(rec.c);
+                    if (!ok)
+                        return false;
+                    extra = inst->targets[0]->num_args +
+                            inst->targets[1]->num_args;
+                    break;
+                case Opcode::JUMP:
+                    inst->targets[0] = target(rec.b);
+                    if (!ok)
+                        return false;
+                    extra = inst->targets[0]->num_args;
+                    break;
+                default:
+                    break;
+                }
+                if (extra && (extra_begin != next_inst_arg ||
+                              extra > header->num_inst_args - next_inst_arg))
+                    return false;
+                uint32_t count = fixed + extra;
+                if (count) {
+                    for (uint32_t j = 0; j < count; ++j) {
+                        new (&uses[j]) IRUse();
+                        uses[j].user = inst;
+                    }
+                    inst->operands = uses;
+                    inst->num_operands = count;
+                    uses += count;
+                }
+                if (fixed > 0)
+                    inst->setOperand(0, value(rec.a));
+                if (fixed > 1)
+                    inst->setOperand(1, value(rec.b));
+                for (uint32_t j = 0; j < extra; ++j)
+                    inst->setOperand(fixed + j,
+                                     value(inst_args[next_inst_arg++]));
+                if (!ok)
+                    return false;
+                // load 的地址、store 的地址只能是 alloc
+                if ((inst->op == Opcode::LOAD && !is_alloc(inst->operand(0))) ||
+                    (inst->op == Opcode::STORE && !is_alloc(inst->operand(1))))
+                    return false;
+                func_blocks[k].append(inst);
+            }
+        }
+    }
+    return next_inst_arg == header->num_inst_args;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "ir.hpp"
+#include "output_buffer.hpp"
+#include "source_buffer.hpp"
+#include <cstdint>
+
+// KIR：IR 的二进制序列化格式（-emit=kir 输出，-from-kir 读入）。
+// 写出的是优化之后的 IR，与 -koopa 输出的相同；加 -O0 则是前端生成的 IR。
+// 文件由定长记录组成，按主机字节序（小端）存放，所有段都 4 字节对齐：
+//
+//   KirHeader
+//   KirType[num_types]          类型，按依赖顺序排列（被引用的在前）
+//   uint32_t[num_type_params]   函数类型的参数类型编号
+//   int32_t[num_consts]         整数常量
+//   KirFunction[num_funcs]
+//   uint32_t[num_args]          各函数参数的名字
+//   KirBlock[num_blocks]        各函数的基本块依次排列
+//   uint32_t[num_block_args]    各基本块参数的名字
+//   KirInst[num_insts]          各基本块的指令依次排列
+//   uint32_t[num_inst_args]     call 的实参、br / jump 传给目标块的实参
+//   char[string_bytes]          字符串表，每个字符串以 '\0' 结尾
+//
+// 值编号是稠密的：[0, 常量数) 为常量，之后依次是所有函数的参数、所有
+// 基本块的参数和所有指令。名字等字符串用字符串表中的偏移表示，
+// KIR_NONE 表示没有。
+// 读入时字符串直接指向映射的文件内容，IR 对象按段整块分配。
+
+constexpr char KIR_MAGIC[4] = {'K', 'I', 'R', '\0'};
+constexpr uint32_t KIR_VERSION = 2; // 2：基本块参数
+constexpr uint32_t KIR_NONE = UINT32_MAX;
+
+struct KirHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t num_types;
+    uint32_t num_type_params;
+    uint32_t num_consts;
+    uint32_t num_funcs;
+    uint32_t num_args;
+    uint32_t num_blocks;
+    uint32_t num_block_args;
+    uint32_t num_insts;
+    uint32_t num_inst_args;
+    uint32_t string_bytes;
+};
+
+struct KirType {
+    uint32_t kind; // IRType::Kind
+    uint32_t a;    // POINTER：指向的类型；FUNCTION：返回类型
+    uint32_t b;    // FUNCTION：第一个参数类型在 type_params 中的下标
+    uint32_t c;    // FUNCTION：参数个数
+};
+
+struct KirFunction {
+    uint32_t name;
+    uint32_t type;
+    uint32_t first_block; // 声明没有基本块，num_blocks 为 0
+    uint32_t num_blocks;
+};
+
+struct KirBlock {
+    uint32_t prefix;
+    int32_t label;
+    uint32_t first_arg; // 参数的类型都是 i32
+    uint32_t num_args;
+    uint32_t first_inst;
+    uint32_t num_insts;
+};
+
+// 操作数的含义随 op 而定：
+//   二元运算 a, b；load a；store a（值）, b（地址）；ret a（可为 KIR_NONE）；
+//   br a（条件）, b / c（目标块）；jump b（目标块）；
+//   call a（被调函数）, b（第一个实参在 inst_args 中的下标）, c（实参个数）
+// br / jump 的实参从 inst_args[d] 开始，依次传给各目标块，个数由目标块的
+// 参数个数决定。inst_args 按指令顺序连续使用。块编号是函数内的下标
+struct KirInst {
+    uint8_t op; // Opcode
+    uint8_t pad[3];
+    uint32_t type;
+    uint32_t name;
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+    uint32_t d;
+};
+static_assert(sizeof(KirBlock) == 24 && sizeof(KirInst) == 28,
+              "KIR 记录的大小是文件格式的一部分");
+
+// 把整个模块写成 KIR
+void write_kir(IRModule &module, OutputBuffer &out);
+// 从已载入（mmap）的 KIR 文件构造模块。file 必须比 module 活得久，
+// 名字直接指向其中的字符串表。格式错误时返回 false，除了各段的结构，
+// 还检查：每个基本块以唯一的 br / jump / ret 结尾；操作数只引用常量或
+// 本函数的值；call 的实参个数、结果类型与被调函数一致；load、store 的
+// 地址是 alloc
+bool read_kir(const SourceBuffer &file, IRModule &module);
@@ -0,0 +1,370 @@
+#include "ir_builder.hpp"
+
+bool IRBuilder::enterFuncDef(FuncDefAST *node) {
+    // 开始函数，参数在这里命名
+    out.beginFunction(node);
+
+    // 重置返回标志并输出函数体，之后在 FUNC_END 补上结尾
+    terminated = false;
+    schedule(node, FUNC_END);
+    schedule(node->block.get());
+    return false;
+}
+
+bool IRBuilder::enterBlockItem(BlockItemAST *) {
+    return !terminated;
+}
+
+bool IRBuilder::enterConstDef(ConstDefAST *node) {
+    // 编译期求出值的常量不占内存，使用处直接是立即数
+    if (node->has_value)
+        return false;
+    out.alloc(node);
+    out.store(emitExp(node->const_init_val.get()), node);
+    return false;
+}
+
+bool IRBuilder::enterVarDef(VarDefAST *node) {
+    out.alloc(node);
+    if (node->init_val)
+        out.store(emitExp(node->init_val.get()), node);
+    return false;
+}
+
+IRBuilder::Value IRBuilder::emitExp(BaseAST *exp) {
+    walk(exp);
+    Value value = values.back();
+    values.pop_back();
+    return value;
+}
+
+// a && b：结果变量先置 0，a 为真时才计算 b，b 的真假存入结果变量。
+// a || b 相同，只是初值为 1、a 为假时才计算 b。
+// 左操作数在 LOGIC_RHS 步骤中求出，是常量时不必生成分支
+bool IRBuilder::enterBinaryExp(BinaryExpAST *node) {
+    if (node->op != BinaryOp::LAND && node->op != BinaryOp::LOR)
+        return true;
+    schedule(node, LOGIC_RHS);
+    schedule(node->lhs.get());
+    return false;
+}
+
+IRBuilder::Value IRBuilder::toBool(Value value) {
+    if (IRInteger *constant = dyn_cast<IRInteger>(value))
+        return out.integer(constant->value != 0);
+    return out.binary(Opcode::NE, value, out.integer(0));
+}
+
+void IRBuilder::leaveBinaryExp(BinaryExpAST *node) {
+    Value rhs = values.back();
+    values.pop_back();
+    Value lhs = values.back();
+    // 两边都是常量时在编译期算出结果（除零等留到运行时）
+    Opcode op = binary_opcode(node->op);
+    IRInteger *l_const = dyn_cast<IRInteger>(lhs);
+    IRInteger *r_const = dyn_cast<IRInteger>(rhs);
+    if (l_const && r_const) {
+        if (std::optional<int32_t> folded =
+                fold_binary(op, l_const->value, r_const->value)) {
+            values.back() = out.integer(*folded);
+            return;
+        }
+    }
+    values.back() = out.binary(op, lhs, rhs);
+}
+
+void IRBuilder::leaveUnaryOpExp(UnaryOpExpAST *node) {
+    Value operand = values.back();
+    if (IRInteger *constant = dyn_cast<IRInteger>(operand)) {
+        values.back() = out.integer(*fold_unary(node->op, constant->value));
+        return;
+    }
+    switch (node->op) {
+    case UnaryOp::POS:
+        return; // 结果就是操作数
+    case UnaryOp::NEG:
+        values.back() = out.binary(Opcode::SUB, out.integer(0), operand);
+        break;
+    case UnaryOp::NOT:
+        values.back() = out.binary(Opcode::EQ, out.integer(0), operand);
+        break;
+    }
+}
+
+void IRBuilder::leaveNumber(NumberAST *node) {
+    values.push_back(out.integer(node->number));
+}
+
+void IRBuilder::leaveCallExp(CallExpAST *node) {
+    // 实参是值栈顶部的 argc 个元素
+    size_t argc = 0;
+    if (node->func_rparams)
+        argc = cast<FuncRParamsAST>(node->func_rparams.get())->params.size();
+    Value result = out.call(node, values.data() + values.size() - argc, argc);
+    values.resize(values.size() - argc);
+    values.push_back(result);
+}
+
+bool IRBuilder::enterLVal(LValAST *node) {
+    const ConstDefAST *def = dyn_cast<ConstDefAST>(node->decl);
+    if (def && def->has_value) {
+        values.push_back(out.integer(def->value));
+        return false;
+    }
+    values.push_back(out.load(node->decl));
+    return false;
+}
+
+bool IRBuilder::enterStmt(StmtAST *node) {
+    switch (node->kind) {
+    case StmtAST::StmtKind::ASSIGN:
+        out.store(emitExp(node->exp.get()),
+                  cast<LValAST>(node->lval.get())->decl);
+        break;
+    case StmtAST::StmtKind::RETURN_EXP:
+        out.ret(emitExp(node->exp.get()));
+        terminated = true;
+        break;
+    case StmtAST::StmtKind::RETURN_EMPTY:
+        out.ret();
+        terminated = true;
+        break;
+    case StmtAST::StmtKind::BLOCK:
+        return true; // 进入子节点 block
+    case StmtAST::StmtKind::SIMPLE_EXP:
+        emitExp(node->exp.get());
+        break;
+    case StmtAST::StmtKind::EMPTY:
+        break;
+    case StmtAST::StmtKind::IF:
+        emitIf(node);
+        break;
+    case StmtAST::StmtKind::IF_ELSE:
+        emitIfElse(node);
+        break;
+    case StmtAST::StmtKind::WHILE:
+        emitWhile(node);
+        break;
+    case StmtAST::StmtKind::BREAK:
+        out.jump({BlockKind::END, node->loop->label});
+        // break 和 return 相似，必须退出这个作用域后才能输出后续语句
+        terminated = true;
+        break;
+    case StmtAST::StmtKind::CONTINUE:
+        // 恒真的循环没有条件块，直接回到循环体开头
+        out.jump({node->loop->infinite ? BlockKind::BODY : BlockKind::COND,
+                  node->loop->label});
+        terminated = true;
+        break;
+    }
+    return false;
+}
+
+void IRBuilder::resume(BaseAST *base, int step) {
+    if (step == FUNC_END) {
+        if (!terminated)
+            out.ret();
+        out.endFunction();
+        return;
+    }
+    if (step == LOGIC_RHS || step == LOGIC_END || step == LOGIC_BOOL) {
+        resumeLogic(cast<BinaryExpAST>(base), step);
+        return;
+    }
+    StmtAST *node = cast<StmtAST>(base);
+    BlockLabel end{BlockKind::END, node->label};
+    switch (step) {
+    case IF_END:
+        if (!terminated)
+            out.jump(end);
+        terminated = false;
+        out.label(end);
+        break;
+    case IF_ELSE_MID: {
+        // then 分支结束，它是否以跳转结尾记在后续步骤的编号里
+        bool then_terminated = terminated;
+        if (!then_terminated)
+            out.jump(end);
+        terminated = false;
+        out.label({BlockKind::ELSE, node->label});
+        schedule(node, then_terminated ? IF_ELSE_END_THEN_TERMINATED
+                                       : IF_ELSE_END);
+        schedule(node->else_stmt.get());
+        break;
+    }
+    case IF_ELSE_END:
+    case IF_ELSE_END_THEN_TERMINATED: {
+        bool else_terminated = terminated;
+        if (!else_terminated)
+            out.jump(end);
+        // 两个分支都已结束时没有后继块，后续语句也不再输出
+        if (step == IF_ELSE_END_THEN_TERMINATED && else_terminated)
+            break;
+        terminated = false;
+        out.label(end);
+        break;
+    }
+    case WHILE_END:
+        if (node->infinite) {
+            if (!terminated)
+                out.jump({BlockKind::BODY, node->label});
+            // 没有 break 的死循环之后的语句都不可达，和 return 一样处理
+            if (!node->has_break) {
+                terminated = true;
+                break;
+            }
+        } else if (!terminated) {
+            out.jump({BlockKind::COND, node->label});
+        }
+        terminated = false;
+        out.label(end);
+        break;
+    }
+}
+
+void IRBuilder::resumeLogic(BinaryExpAST *node, int step) {
+    bool is_and = node->op == BinaryOp::LAND;
+    switch (step) {
+    case LOGIC_RHS: {
+        Value lhs = values.back();
+        values.pop_back();
+        if (IRInteger *constant = dyn_cast<IRInteger>(lhs)) {
+            // && 左边为假、|| 左边为真时结果已定，右边不求值
+            if ((constant->value != 0) != is_and) {
+                values.push_back(out.integer(is_and ? 0 : 1));
+                return;
+            }
+            schedule(node, LOGIC_BOOL);
+            schedule(node->rhs.get());
+            return;
+        }
+        Logic state{out.allocTemp(), next_label++};
+        out.storeTemp(out.integer(is_and ? 0 : 1), state.result);
+        BlockLabel rhs_block{BlockKind::RHS, state.label};
+        BlockLabel end{BlockKind::END, state.label};
+        if (is_and)
+            out.branch(lhs, rhs_block, end);
+        else
+            out.branch(lhs, end, rhs_block);
+        out.label(rhs_block);
+        logic.push_back(state);
+        schedule(node, LOGIC_END);
+        schedule(node->rhs.get());
+        break;
+    }
+    case LOGIC_END: {
+        Logic state = logic.back();
+        logic.pop_back();
+        out.storeTemp(toBool(values.back()), state.result);
+        BlockLabel end{BlockKind::END, state.label};
+        out.jump(end);
+        out.label(end);
+        values.back() = out.loadTemp(state.result);
+        break;
+    }
+    case LOGIC_BOOL:
+        values.back() = toBool(values.back());
+        break;
+    }
+}
+
+void IRBuilder::emitCond(BaseAST *exp, BlockLabel true_block,
+                         BlockLabel false_block) {
+    // 显式栈代替递归：a && b 先对 a 跳转（真时到 b 所在的块），
+    // 再在新块中对 b 跳转。before 是处理该项之前要开始的块
+    struct Item {
+        BaseAST *exp;
+        BlockLabel true_block, false_block;
+        bool has_before;
+        BlockLabel before;
+    };
+    std::vector<Item> items{{exp, true_block, false_block, false, {}}};
+    while (!items.empty()) {
+        Item item = items.back();
+        items.pop_back();
+        if (item.has_before)
+            out.label(item.before);
+        if (BinaryExpAST *bin = dyn_cast<BinaryExpAST>(item.exp)) {
+            if (bin->op == BinaryOp::LAND || bin->op == BinaryOp::LOR) {
+                BlockLabel rhs_block{BlockKind::RHS, next_label++};
+                items.push_back({bin->rhs.get(), item.true_block,
+                                 item.false_block, true, rhs_block});
+                if (bin->op == BinaryOp::LAND)
+                    items.push_back({bin->lhs.get(), rhs_block,
+                                     item.false_block, false, {}});
+                else
+                    items.push_back({bin->lhs.get(), item.true_block,
+                                     rhs_block, false, {}});
+                continue;
+            }
+        }
+        if (UnaryOpExpAST *unary = dyn_cast<UnaryOpExpAST>(item.exp)) {
+            if (unary->op == UnaryOp::NOT) { // 交换两个目标
+                items.push_back({unary->operand.get(), item.false_block,
+                                 item.true_block, false, {}});
+                continue;
+            }
+        }
+        Value cond = emitExp(item.exp);
+        if (IRInteger *constant = dyn_cast<IRInteger>(cond))
+            out.jump(constant->value ? item.true_block : item.false_block);
+        else
+            out.branch(cond, item.true_block, item.false_block);
+    }
+}
+
+void IRBuilder::emitIf(StmtAST *node) {
+    // 条件恒定时不生成跳转，恒真时 then 分支直接接在当前块中
+    if (std::optional<int> cond = folder.evaluate(node->exp.get())) {
+        if (*cond)
+            schedule(node->then_stmt.get());
+        return;
+    }
+    node->label = next_label++;
+
+    BlockLabel then_block{BlockKind::THEN, node->label};
+    emitCond(node->exp.get(), then_block, {BlockKind::END, node->label});
+    out.label(then_block);
+    schedule(node, IF_END);
+    schedule(node->then_stmt.get());
+}
+
+void IRBuilder::emitIfElse(StmtAST *node) {
+    if (std::optional<int> cond = folder.evaluate(node->exp.get())) {
+        schedule(*cond ? node->then_stmt.get() : node->else_stmt.get());
+        return;
+    }
+    node->label = next_label++;
+
+    BlockLabel then_block{BlockKind::THEN, node->label};
+    emitCond(node->exp.get(), then_block, {BlockKind::ELSE, node->label});
+    out.label(then_block);
+    schedule(node, IF_ELSE_MID);
+    schedule(node->then_stmt.get());
+}
+
+void IRBuilder::emitWhile(StmtAST *node) {
+    std::optional<int> cond = folder.evaluate(node->exp.get());
+    if (cond && !*cond)
+        return; // 循环体一次也不执行
+
+    // 标号先分配好，循环体中的 break/continue 通过 loop 指针读取
+    node->label = next_label++;
+
+    BlockLabel cond_block{BlockKind::COND, node->label};
+    BlockLabel body_block{BlockKind::BODY, node->label};
+    if (cond) { // 恒真：循环体的末尾直接跳回开头
+        node->infinite = true;
+        out.jump(body_block);
+        out.label(body_block);
+        schedule(node, WHILE_END);
+        schedule(node->then_stmt.get());
+        return;
+    }
+    out.jump(cond_block);
+    out.label(cond_block);
+    emitCond(node->exp.get(), body_block, {BlockKind::END, node->label});
+    out.label(body_block);
+    schedule(node, WHILE_END);
+    schedule(node->then_stmt.get());
+}
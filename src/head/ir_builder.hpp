@@ -0,0 +1,81 @@
+#pragma once
+#include "const_eval.hpp"
+#include "ir_emitter.hpp"
+#include "visitor.hpp"
+#include <vector>
+
+// 生成 IR 的遍：在名字绑定和常量求值之后运行，通过 IREmitter 把语法树
+// 翻译为 IRModule 中的 IR（见 ir.hpp）。
+// 语句和表达式都在 ASTVisitor 的显式工作栈上处理，不随嵌套深度递归。
+// 基本块标号分配后缓存在对应的语句节点上。条件恒定的 if 只输出会执行的
+// 分支，while (0) 整个省略，while (1) 没有条件块。
+class IRBuilder : public ASTVisitor<IRBuilder> {
+public:
+    using Value = IREmitter::Value;
+
+    // 逐函数编译时每个函数用一个新的 IRBuilder，first_label 接着上一个
+    // 函数的 nextLabel()，使输出与整体编译相同
+    explicit IRBuilder(IREmitter &out, int first_label = 0)
+        : out(out), next_label(first_label) {
+    }
+    void build(BaseAST *root) {
+        walk(root);
+    }
+    int nextLabel() const {
+        return next_label;
+    }
+
+    // 语句
+    bool enterFuncDef(FuncDefAST *node);
+    bool enterBlockItem(BlockItemAST *node);
+    bool enterConstDef(ConstDefAST *node);
+    bool enterVarDef(VarDefAST *node);
+    bool enterStmt(StmtAST *node);
+    void resume(BaseAST *node, int step);
+
+    // 表达式：后序输出，结果放在值栈上。常量是 IRInteger，两边都是常量的
+    // 运算在编译期折叠，不生成指令。&&/|| 短路求值，见 enterBinaryExp()
+    bool enterBinaryExp(BinaryExpAST *node);
+    void leaveBinaryExp(BinaryExpAST *node);
+    void leaveUnaryOpExp(UnaryOpExpAST *node);
+    void leaveNumber(NumberAST *node);
+    void leaveCallExp(CallExpAST *node);
+    bool enterLVal(LValAST *node);
+
+private:
+    // 语句中插在子节点之间的步骤，见 resume()
+    enum Step {
+        FUNC_END = 1,
+        IF_END,
+        IF_ELSE_MID,
+        IF_ELSE_END,
+        IF_ELSE_END_THEN_TERMINATED,
+        WHILE_END,
+        LOGIC_RHS,  // &&/|| 的左操作数已求出
+        LOGIC_END,  // 右操作数已求出，合并到结果变量
+        LOGIC_BOOL  // 左操作数是常量，结果就是右操作数的真假
+    };
+    // 正在求值的 &&/||：结果所在的临时变量和基本块标号
+    struct Logic {
+        Value result;
+        int label;
+    };
+
+    Value emitExp(BaseAST *exp); // 输出表达式，返回结果
+    // 输出条件跳转：exp 为真时跳到 true_block，否则跳到 false_block。
+    // &&/||/! 直接变成跳转，不生成中间的 0/1 值
+    void emitCond(BaseAST *exp, BlockLabel true_block, BlockLabel false_block);
+    Value toBool(Value value); // 非零为 1，零为 0
+    void resumeLogic(BinaryExpAST *node, int step);
+    void emitIf(StmtAST *node);
+    void emitIfElse(StmtAST *node);
+    void emitWhile(StmtAST *node);
+
+    IREmitter &out;
+    // 当前基本块已经以 ret/jump 结束时，同一作用域内的后续语句不再输出
+    bool terminated = false;
+    int next_label = 0; // 基本块标号
+    std::vector<Value> values;
+    std::vector<Logic> logic;
+    ConstFolder folder; // 判断 if/while 的条件是否恒定
+};
@@ -0,0 +1,175 @@
+#include "ir_emitter.hpp"
+#include <vector>
+
+const IRType *ir_type(IRModule &module, const std::string &name) {
+    if (name == "void")
+        return module.unitType();
+    if (name == "*i32")
+        return module.pointerType(module.i32Type());
+    return module.i32Type();
+}
+
+static const char *block_prefix(BlockKind kind) {
+    switch (kind) {
+    case BlockKind::THEN:
+        return "then";
+    case BlockKind::ELSE:
+        return "else";
+    case BlockKind::END:
+        return "end";
+    case BlockKind::COND:
+        return "cond";
+    case BlockKind::BODY:
+        return "body";
+    case BlockKind::RHS:
+        return "rhs";
+    }
+    return "";
+}
+
+void IREmitter::beginFunction(FuncDefAST *node) {
+    cur_func = function(node->func);
+    block_map.clear();
+    vars.assign(node->num_slots, nullptr);
+
+    cur_block = module.newBlock("entry");
+    cur_func->append(cur_block);
+
+    // 参数以源程序中的名字命名。没有被赋值过的参数直接作为值使用，
+    // 被赋值的先存入同名的局部变量
+    if (node->func_params) {
+        const ASTList &params =
+            cast<FuncFParamsAST>(node->func_params.get())->params;
+        for (size_t i = 0; i < params.size(); ++i) {
+            const FuncFParamAST *param = cast<FuncFParamAST>(params[i].get());
+            IRArgument *arg = cur_func->args[i];
+            arg->name = interner.str(param->ident);
+            vars[param->slot] = arg;
+            if (param->assigned) {
+                alloc(param);
+                store(arg, param);
+            }
+        }
+    }
+}
+
+void IREmitter::endFunction() {
+    cur_func = nullptr;
+    cur_block = nullptr;
+}
+
+void IREmitter::label(BlockLabel target) {
+    cur_block = block(target);
+    cur_func->append(cur_block);
+}
+
+IREmitter::Value IREmitter::binary(Opcode op, Value lhs, Value rhs) {
+    return append(module.newInst(op, module.i32Type(), {lhs, rhs}));
+}
+
+void IREmitter::alloc(const BaseAST *decl) {
+    IRInst *inst = module.newInst(Opcode::ALLOC,
+                                  module.pointerType(module.i32Type()));
+    if (const ConstDefAST *def = dyn_cast<ConstDefAST>(decl))
+        inst->name = interner.str(def->ident);
+    else if (const VarDefAST *def = dyn_cast<VarDefAST>(decl))
+        inst->name = interner.str(def->ident);
+    else
+        inst->name = interner.str(cast<FuncFParamAST>(decl)->ident);
+    vars[decl_slot(decl)] = append(inst);
+}
+
+IREmitter::Value IREmitter::load(const BaseAST *decl) {
+    IRValue *var = vars[decl_slot(decl)];
+    if (isa<IRArgument>(var)) // 参数本身就是值，不需要复制
+        return var;
+    return append(module.newInst(Opcode::LOAD, module.i32Type(), {var}));
+}
+
+void IREmitter::store(Value value, const BaseAST *decl) {
+    append(module.newInst(Opcode::STORE, module.unitType(),
+                          {value, vars[decl_slot(decl)]}));
+}
+
+IREmitter::Value IREmitter::allocTemp() {
+    IRInst *inst = module.newInst(Opcode::ALLOC,
+                                  module.pointerType(module.i32Type()));
+    IRBlock *entry = cur_func->entry();
+    if (entry->first)
+        entry->insertBefore(inst, entry->first);
+    else
+        entry->append(inst);
+    return inst;
+}
+
+IREmitter::Value IREmitter::loadTemp(Value slot) {
+    return append(module.newInst(Opcode::LOAD, module.i32Type(), {slot}));
+}
+
+void IREmitter::storeTemp(Value value, Value slot) {
+    append(module.newInst(Opcode::STORE, module.unitType(), {value, slot}));
+}
+
+IREmitter::Value IREmitter::call(const CallExpAST *node, const Value *args,
+                                 size_t argc) {
+    IRFunction *callee = function(node->callee);
+    IRInst *inst =
+        module.newInst(Opcode::CALL, callee->type->ret, args, argc);
+    inst->callee = callee;
+    return append(inst);
+}
+
+void IREmitter::ret(Value value) {
+    append(module.newInst(Opcode::RET, module.unitType(), {value}));
+}
+
+void IREmitter::ret() {
+    append(module.newInst(Opcode::RET, module.unitType()));
+}
+
+void IREmitter::jump(BlockLabel target) {
+    append(module.newJump(block(target)));
+}
+
+void IREmitter::branch(Value cond, BlockLabel then_block,
+                       BlockLabel else_block) {
+    append(module.newBranch(cond, block(then_block), {}, block(else_block),
+                            {}));
+}
+
+// 按符号表中的编号缓存，每个函数只在第一次用到时按名字查找一次。
+// 函数在定义时创建；库函数已经由 main 预先声明
+IRFunction *IREmitter::function(const SymbolTable::Function *func) {
+    if (func->index >= functions.size())
+        functions.resize(func->index + 1, nullptr);
+    IRFunction *&cached = functions[func->index];
+    if (cached)
+        return cached;
+    const char *name = interner.str(func->name);
+    cached = module.findFunction(name);
+    if (cached)
+        return cached;
+    std::vector<const IRType *> params;
+    for (const std::string &param : func->param_types)
+        params.push_back(ir_type(module, param));
+    cached = module.addFunction(
+        name,
+        module.functionType(params, ir_type(module, func->return_type)));
+    return cached;
+}
+
+IRBlock *IREmitter::block(BlockLabel target) {
+    uint64_t key = static_cast<uint64_t>(target.label) << 3 |
+                   static_cast<uint64_t>(target.kind);
+    auto it = block_map.find(key);
+    if (it != block_map.end())
+        return it->second;
+    IRBlock *bb = module.newBlock(block_prefix(target.kind), target.label);
+    block_map.emplace(key, bb);
+    return bb;
+}
+
+IRInst *IREmitter::append(IRInst *inst) {
+    cur_block->append(inst);
+    return inst;
+}
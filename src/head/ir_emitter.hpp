@@ -0,0 +1,67 @@
+#pragma once
+#include "ast.hpp"
+#include "exp.hpp"
+#include "ir.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// IRBuilder 的输出端：把 IRBuilder 决定生成的指令依次追加到 IRModule 中
+// 当前函数的当前基本块末尾。integer() 得到的常量不生成指令。
+
+// 基本块：if/while 语句或 &&/|| 的标号加上块的用途，如 %then_3、%end_3。
+// RHS 是 &&/|| 计算右操作数的块
+enum class BlockKind : uint8_t { THEN, ELSE, END, COND, BODY, RHS };
+struct BlockLabel {
+    BlockKind kind;
+    int label;
+};
+
+class IREmitter {
+public:
+    using Value = IRValue *;
+
+    explicit IREmitter(IRModule &module) : module(module) {
+    }
+
+    // 开始一个函数并进入它的入口块
+    void beginFunction(FuncDefAST *node);
+    void endFunction();
+    // 开始一个新的基本块，之后的指令追加到其中
+    void label(BlockLabel block);
+
+    Value integer(int value) {
+        return module.integer(value);
+    }
+    Value binary(Opcode op, Value lhs, Value rhs);
+    void alloc(const BaseAST *decl);
+    Value load(const BaseAST *decl);
+    void store(Value value, const BaseAST *decl);
+    // 没有名字的临时变量（分配在入口块开头），用于 &&/|| 的结果
+    Value allocTemp();
+    Value loadTemp(Value slot);
+    void storeTemp(Value value, Value slot);
+    Value call(const CallExpAST *node, const Value *args, size_t argc);
+    void ret(Value value);
+    void ret();
+    void jump(BlockLabel target);
+    void branch(Value cond, BlockLabel then_block, BlockLabel else_block);
+
+private:
+    IRFunction *function(const SymbolTable::Function *func);
+    // 同一个 (用途, 标号) 总是得到同一个基本块，跳转可以先于块本身出现
+    IRBlock *block(BlockLabel target);
+    IRInst *append(IRInst *inst);
+
+    IRModule &module;
+    IRFunction *cur_func = nullptr;
+    IRBlock *cur_block = nullptr;
+    std::unordered_map<uint64_t, IRBlock *> block_map;
+    // 以声明的 slot 为下标：变量的 alloc，或没有被赋值过的参数本身
+    std::vector<IRValue *> vars;
+    // 以 SymbolTable::Function::index 为下标
+    std::vector<IRFunction *> functions;
+};
+
+// 把库函数或 SysY 中的类型名（"int"/"i32"/"*i32"/"void"）转为 IR 类型
+const IRType *ir_type(IRModule &module, const std::string &name);
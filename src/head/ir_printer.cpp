@@ -0,0 +1,171 @@
+#include "ir_printer.hpp"
+
+static void print_type(const IRType *ty, OutputBuffer &out) {
+    switch (ty->kind) {
+    case IRType::I32:
+        out << "i32";
+        break;
+    case IRType::UNIT:
+        break;
+    case IRType::POINTER:
+        out << '*';
+        print_type(ty->base, out);
+        break;
+    case IRType::FUNCTION:
+        out << '(';
+        for (uint32_t i = 0; i < ty->num_params; ++i) {
+            if (i)
+                out << ", ";
+            print_type(ty->params[i], out);
+        }
+        out << ')';
+        if (!ty->ret->isUnit()) {
+            out << ": ";
+            print_type(ty->ret, out);
+        }
+        break;
+    }
+}
+
+static void print_value(const IRValue *value, OutputBuffer &out) {
+    if (const IRInteger *constant = dyn_cast<IRInteger>(value)) {
+        out << constant->value;
+        return;
+    }
+    const IRInst *inst = dyn_cast<IRInst>(value);
+    if (value->name) // 局部变量在 Koopa 中是 @ 开头的名字
+        out << (inst && inst->op == Opcode::ALLOC ? '@' : '%') << value->name
+            << '_' << value->id;
+    else
+        out << '%' << value->id;
+}
+
+static void print_block_name(const IRBlock *block, OutputBuffer &out) {
+    out << '%' << block->prefix;
+    if (block->label >= 0)
+        out << '_' << block->label;
+}
+
+// 跳转目标及传给它的实参：%bb(%1, 2)
+static void print_target(const IRInst *inst, uint32_t t, OutputBuffer &out) {
+    const IRBlock *target = inst->targets[t];
+    print_block_name(target, out);
+    if (!target->num_args)
+        return;
+    uint32_t begin = inst->targetArgBegin(t);
+    out << '(';
+    for (uint32_t i = 0; i < target->num_args; ++i) {
+        if (i)
+            out << ", ";
+        print_value(inst->operand(begin + i), out);
+    }
+    out << ')';
+}
+
+static void print_inst(const IRInst *inst, OutputBuffer &out) {
+    if (!inst->type->isUnit()) {
+        print_value(inst, out);
+        out << " = ";
+    }
+    out << opcode_name(inst->op);
+    switch (inst->op) {
+    case Opcode::ALLOC:
+        out << ' ';
+        print_type(inst->type->base, out);
+        break;
+    case Opcode::CALL:
+        out << " @" << inst->callee->name << '(';
+        for (uint32_t i = 0; i < inst->num_operands; ++i) {
+            if (i)
+                out << ", ";
+            print_value(inst->operand(i), out);
+        }
+        out << ')';
+        break;
+    case Opcode::BR:
+        out << ' ';
+        print_value(inst->operand(0), out);
+        out << ", ";
+        print_target(inst, 0, out);
+        out << ", ";
+        print_target(inst, 1, out);
+        break;
+    case Opcode::JUMP:
+        out << ' ';
+        print_target(inst, 0, out);
+        break;
+    default: // 二元运算、load、store、ret：依次输出操作数
+        for (uint32_t i = 0; i < inst->num_operands; ++i) {
+            out << (i ? ", " : " ");
+            print_value(inst->operand(i), out);
+        }
+        break;
+    }
+    out << '\n';
+}
+
+void print_koopa_function(IRFunction *func, OutputBuffer &out) {
+    if (func->isDeclaration()) {
+        out << "decl @" << func->name;
+        print_type(func->type, out);
+        out << '\n';
+        return;
+    }
+
+    // 编号：参数在前，之后依次是每个基本块的参数和有结果的指令
+    int next_id = 0;
+    for (uint32_t i = 0; i < func->num_args; ++i)
+        func->args[i]->id = next_id++;
+    for (IRBlock *block : blocks(func)) {
+        for (uint32_t i = 0; i < block->num_args; ++i)
+            block->args[i]->id = next_id++;
+        for (IRInst *inst : insts(block))
+            if (!inst->type->isUnit())
+                inst->id = next_id++;
+    }
+
+    out << "fun @" << func->name << '(';
+    for (uint32_t i = 0; i < func->num_args; ++i) {
+        if (i)
+            out << ", ";
+        print_value(func->args[i], out);
+        out << ": ";
+        print_type(func->args[i]->type, out);
+    }
+    out << ')';
+    if (!func->type->ret->isUnit()) {
+        out << ": ";
+        print_type(func->type->ret, out);
+    }
+    out << " {\n";
+    for (IRBlock *block : blocks(func)) {
+        if (block != func->entry())
+            out << '\n';
+        print_block_name(block, out);
+        if (block->num_args) {
+            out << '(';
+            for (uint32_t i = 0; i < block->num_args; ++i) {
+                if (i)
+                    out << ", ";
+                print_value(block->args[i], out);
+                out << ": ";
+                print_type(block->args[i]->type, out);
+            }
+            out << ')';
+        }
+        out << ":\n";
+        for (IRInst *inst : insts(block))
+            print_inst(inst, out);
+    }
+    out << "}\n";
+}
+
+void print_koopa(IRModule &module, OutputBuffer &out) {
+    // 声明集中在开头
+    for (IRFunction *func : module.functions())
+        if (func->isDeclaration())
+            print_koopa_function(func, out);
+    for (IRFunction *func : module.functions())
+        if (!func->isDeclaration())
+            print_koopa_function(func, out);
+}
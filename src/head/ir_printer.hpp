@@ -0,0 +1,9 @@
+#pragma once
+#include "ir.hpp"
+#include "output_buffer.hpp"
+
+// 把 IR 输出为 Koopa IR 文本。临时值按出现顺序在每个函数内重新编号
+// （%0, %1, ...），有名字的值打印为 @name_N / %name_N，与临时值共用编号
+void print_koopa(IRModule &module, OutputBuffer &out);
+// 只输出一个函数（声明或定义），供逐函数编译使用
+void print_koopa_function(IRFunction *func, OutputBuffer &out);
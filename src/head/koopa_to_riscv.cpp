@@ -1,295 +1,483 @@
 #include "koopa_to_riscv.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
 
-using namespace std;
+// 当前函数的栈帧（从 sp 向上）：
+//   [0, 4 * 调用时最多的栈上实参数)  传给被调函数的第 9 个及之后的实参
+//   之后每个值一个槽                  偏移记在 IRValue::id 中
+//   最高的 4 字节                     保存的 ra（函数中有调用时）
+struct Frame {
+    int size = 0;
+    bool saves_ra = false;
+};
+static Frame frame;
 
-// 全局变量定义
-int stack_offset = 0;
-unordered_map<koopa_raw_value_t, int> value_to_offset;
+static const char *const arg_regs[] = {"a0", "a1", "a2", "a3",
+                                       "a4", "a5", "a6", "a7"};
 
-// 重置全局状态
-void reset_state() {
-    stack_offset = 0;
-    value_to_offset.clear();
+static bool fits_imm12(int value) {
+    return value >= -2048 && value <= 2047;
 }
 
-// 为值分配栈空间并返回偏移量
-int allocate_stack(koopa_raw_value_t value) {
-    int offset = stack_offset;
-    value_to_offset[value] = offset;
-    stack_offset += 4; // 每个值占 4 字节 (i32)
-    return offset;
+// lw/sw reg, offset(sp)。偏移超出 12 位立即数时借用 t3 计算地址
+static void access_stack(const char *op, const char *reg, int offset,
+                         OutputBuffer &out) {
+    if (fits_imm12(offset)) {
+        out << "  " << op << ' ' << reg << ", " << offset << "(sp)\n";
+        return;
+    }
+    out << "  li t3, " << offset << "\n";
+    out << "  add t3, sp, t3\n";
+    out << "  " << op << ' ' << reg << ", 0(t3)\n";
 }
 
-// 获取值的栈偏移量
-int get_stack_offset(koopa_raw_value_t value) {
-    auto it = value_to_offset.find(value);
-    assert(it != value_to_offset.end()); // 确保值已分配
-    return it->second;
+static void adjust_sp(int delta, OutputBuffer &out) {
+    if (fits_imm12(delta)) {
+        out << "  addi sp, sp, " << delta << "\n";
+    } else {
+        out << "  li t3, " << delta << "\n";
+        out << "  add sp, sp, t3\n";
+    }
 }
 
-// 访问 raw program
-void generate_riscv(const koopa_raw_program_t &program, std::ostream &out) {
-    reset_state();
-    out << "  .text\n";
-    for (size_t i = 0; i < program.funcs.len; ++i) {
-        assert(program.funcs.kind == KOOPA_RSIK_FUNCTION);
-        koopa_raw_function_t func =
-            (koopa_raw_function_t)program.funcs.buffer[i];
-        generate_riscv(func, out);
-    }
+// 加载操作数到寄存器：常量直接 li，其余从自己的槽中读取
+static void load_operand(const IRValue *operand, const char *reg,
+                         OutputBuffer &out) {
+    if (const IRInteger *constant = dyn_cast<IRInteger>(operand))
+        out << "  li " << reg << ", " << constant->value << "\n";
+    else
+        access_stack("lw", reg, operand->id, out);
+}
+
+static void print_label(const IRBlock *block, OutputBuffer &out) {
+    out << block->prefix << '_' << block->label;
 }
 
-// 访问函数
-void generate_riscv(const koopa_raw_function_t &func, std::ostream &out) {
-    out << "  .globl " << (func->name + 1) << "\n"; // 跳过 '@' 前缀
-    out << (func->name + 1) << ":\n";
+// 只被同一基本块中的 br 用作条件（而不是实参）的比较：不计算 0/1 结果，也不占栈槽，
+// 由 br 直接生成比较跳转指令。操作数的栈槽写入后不会再变，
+// 推迟到 br 处读取得到的值相同
+static bool is_fused_compare(const IRInst *inst) {
+    if (inst->op > Opcode::LE) // 比较运算排在 Opcode 的最前面
+        return false;
+    const IRUse *use = inst->uses;
+    return use && !use->next && use->user->op == Opcode::BR &&
+           use == &use->user->operands[0] &&
+           use->user->parent == inst->parent;
+}
 
-    // 在函数入口分配栈空间
-    reset_state(); // 重置栈状态
-    for (size_t i = 0; i < func->bbs.len; ++i) {
-        assert(func->bbs.kind == KOOPA_RSIK_BASIC_BLOCK);
-        koopa_raw_basic_block_t bb =
-            (koopa_raw_basic_block_t)func->bbs.buffer[i];
-        // 先遍历所有指令以确定栈大小
-        for (size_t j = 0; j < bb->insts.len; ++j) {
-            koopa_raw_value_t value = (koopa_raw_value_t)bb->insts.buffer[j];
-            if (value->kind.tag == KOOPA_RVT_BINARY ||
-                value->kind.tag == KOOPA_RVT_RETURN ||
-                value->kind.tag == KOOPA_RVT_ALLOC ||
-                value->kind.tag == KOOPA_RVT_LOAD ||
-                value->kind.tag == KOOPA_RVT_STORE ||
-                value->kind.tag == KOOPA_RVT_BRANCH ||
-                value->kind.tag == KOOPA_RVT_JUMP) {
-                allocate_stack(value);
-            }
+// 为参数、基本块参数和有结果的指令分配栈槽，确定栈帧大小
+static void layout_frame(IRFunction *func) {
+    int stack_args = 0;
+    bool has_call = false;
+    for (IRBlock *block : blocks(func)) {
+        for (IRInst *inst : insts(block)) {
+            if (inst->op != Opcode::CALL)
+                continue;
+            has_call = true;
+            stack_args =
+                std::max(stack_args, static_cast<int>(inst->num_operands) - 8);
         }
     }
-    int total_stack_size = (stack_offset + 15) & ~15; // 16 字节对齐
-    if (total_stack_size > 0) {
-        out << "  addi sp, sp, -" << total_stack_size << "\n";
-        out << "  sw ra, " << (total_stack_size - 4)
-            << "(sp)\n"; // 保存返回地址
+    int offset = stack_args * 4;
+    for (uint32_t i = 0; i < func->num_args; ++i) {
+        func->args[i]->id = offset;
+        offset += 4;
     }
-
-    // 生成基本块代码
-    for (size_t i = 0; i < func->bbs.len; ++i) {
-        koopa_raw_basic_block_t bb =
-            (koopa_raw_basic_block_t)func->bbs.buffer[i];
-        generate_riscv(bb, out);
+    for (IRBlock *block : blocks(func)) {
+        for (uint32_t i = 0; i < block->num_args; ++i) {
+            block->args[i]->id = offset;
+            offset += 4;
+        }
+        for (IRInst *inst : insts(block)) {
+            if (inst->type->isUnit() || is_fused_compare(inst))
+                continue;
+            inst->id = offset;
+            offset += 4;
+        }
     }
+    if (has_call)
+        offset += 4;
+    frame.size = (offset + 15) & ~15; // 16 字节对齐
+    frame.saves_ra = has_call;
 }
 
-// 访问基本块
-void generate_riscv(const koopa_raw_basic_block_t &bb, std::ostream &out) {
-    if (bb->name && strlen(bb->name) > 0) {
-        out << (bb->name + 1) << ":\n"; // 跳过 '%' 前缀
-    }
-    for (size_t i = 0; i < bb->insts.len; ++i) {
-        assert(bb->insts.kind == KOOPA_RSIK_VALUE);
-        koopa_raw_value_t value = (koopa_raw_value_t)bb->insts.buffer[i];
-        generate_riscv(value, out);
+// 右操作数是 12 位立即数时改用 I 型指令，省掉 li。成功时返回 true
+static bool generate_binary_imm(Opcode op, const IRValue *lhs, int imm,
+                                OutputBuffer &out) {
+    if (op == Opcode::SUB && imm != INT32_MIN) { // x - k 即 x + (-k)
+        op = Opcode::ADD;
+        imm = -imm;
     }
-}
-
-// 访问指令
-void generate_riscv(const koopa_raw_value_t &value, std::ostream &out) {
-    switch (value->kind.tag) {
-    case KOOPA_RVT_RETURN:
-        generate_riscv(value->kind.data.ret, out);
-        break;
-    case KOOPA_RVT_INTEGER:
-        generate_riscv(value->kind.data.integer, out);
+    const char *mnemonic = nullptr;
+    switch (op) {
+    case Opcode::ADD:
+        mnemonic = "addi";
         break;
-    case KOOPA_RVT_BINARY:
-        generate_riscv(value->kind.data.binary, value, out);
+    case Opcode::AND:
+        mnemonic = "andi";
         break;
-    case KOOPA_RVT_ALLOC:
-        // 因为我们已经在进入函数的时候申请了栈帧，所以现在不需要再处理这个指令了
+    case Opcode::OR:
+        mnemonic = "ori";
         break;
-    case KOOPA_RVT_STORE:
-        generate_riscv(value->kind.data.store, out);
+    case Opcode::XOR:
+        mnemonic = "xori";
         break;
-    case KOOPA_RVT_LOAD:
-        generate_riscv(value->kind.data.load, value, out);
-        break;
-    case KOOPA_RVT_JUMP:
-        generate_riscv(value->kind.data.jump, out);
-        break;
-    case KOOPA_RVT_BRANCH: // 新增分支指令支持
-        generate_riscv(value->kind.data.branch, out);
+    case Opcode::LT:
+        mnemonic = "slti";
         break;
+    case Opcode::EQ:
+    case Opcode::NE:
+        if (imm == INT32_MIN || !fits_imm12(-imm))
+            return false;
+        load_operand(lhs, "t0", out);
+        out << "  addi t2, t0, " << -imm << "\n"; // t2 = t0 - imm
+        out << (op == Opcode::EQ ? "  seqz t2, t2\n" : "  snez t2, t2\n");
+        return true;
     default:
-        assert(false); // 未处理的指令类型
-    }
-}
-// 访问 jump 指令
-void generate_riscv(const koopa_raw_jump_t &jump, std::ostream &out) {
-    const koopa_raw_basic_block_t target = jump.target;
-    out << "  j " << (target->name + 1)
-        << "\n"; // 跳过 '%' 前缀，直接跳转到目标标签
-}
-// 访问 br 分支命令
-void generate_riscv(const koopa_raw_branch_t &branch, std::ostream &out) {
-    const koopa_raw_value_t cond = branch.cond;               // 条件值
-    const koopa_raw_basic_block_t true_bb = branch.true_bb;   // then 块
-    const koopa_raw_basic_block_t false_bb = branch.false_bb; // else 块
-
-    // 加载条件值到 t0
-    if (cond->kind.tag == KOOPA_RVT_INTEGER) {
-        out << "  li t0, " << cond->kind.data.integer.value << "\n";
-    } else {
-        int cond_offset = get_stack_offset(cond);
-        out << "  lw t0, " << cond_offset << "(sp)\n";
-    }
-
-    // 生成条件分支：如果 t0 != 0，则跳转到 true_bb，否则跳转到 false_bb
-    out << "  bnez t0, " << (true_bb->name + 1)
-        << "\n"; // 如果条件为真，跳转到 then 块
-    out << "  j " << (false_bb->name + 1) << "\n"; // 否则跳转到 else 块
-}
-// 访问 load 指令
-void generate_riscv(const koopa_raw_load_t &load,
-                    const koopa_raw_value_t &value, std::ostream &out) {
-    const koopa_raw_value_t &src_value = load.src;
-    assert(src_value->kind.tag == KOOPA_RVT_ALLOC); // 目前只支持从 alloc 加载
-
-    // 获取源地址的栈偏移量
-    int src_offset = get_stack_offset(src_value);
-
-    // 从栈加载值到 t0
-    out << "  lw t0, " << src_offset << "(sp)\n";
-
-    // 获取 load 结果的栈偏移量
-    int result_offset = get_stack_offset(value);
-
-    // 将结果存储到栈上
-    out << "  sw t0, " << result_offset << "(sp)\n";
-}
-
-// 访问 store 指令
-void generate_riscv(const koopa_raw_store_t &store, std::ostream &out) {
-    const koopa_raw_value_t &src_value = store.value; // 源值（如 %2）
-    const koopa_raw_value_t &dest_value = store.dest; // 目标地址（如 @x）
-
-    // 加载源值到 t0
-    if (src_value->kind.tag == KOOPA_RVT_INTEGER) {
-        int32_t int_val = src_value->kind.data.integer.value;
-        out << "  li t0, " << int_val << "\n";
-    } else {
-        int src_offset = get_stack_offset(src_value);
-        out << "  lw t0, " << src_offset << "(sp)\n"; // 从栈加载源值
+        return false;
     }
-
-    // 获取目标地址的栈偏移量
-    assert(dest_value->kind.tag ==
-           KOOPA_RVT_ALLOC); // 目前只支持 alloc 类型的目标
-    int dest_offset = get_stack_offset(dest_value);
-
-    // 存储值到目标地址
-    out << "  sw t0, " << dest_offset << "(sp)\n";
+    if (!fits_imm12(imm))
+        return false;
+    load_operand(lhs, "t0", out);
+    out << "  " << mnemonic << " t2, t0, " << imm << "\n";
+    return true;
 }
 
-// 访问 return 指令
-void generate_riscv(const koopa_raw_return_t &ret, std::ostream &out) {
-    koopa_raw_value_t ret_value = ret.value;
-    if (ret_value) {
-        if (ret_value->kind.tag == KOOPA_RVT_INTEGER) {
-            out << "  li a0, " << ret_value->kind.data.integer.value << "\n";
-        } else {
-            int offset = get_stack_offset(ret_value);
-            out << "  lw a0, " << offset << "(sp)\n"; // 从栈加载返回值
+static void generate_binary(const IRInst *inst, OutputBuffer &out) {
+    const IRValue *lhs = inst->operand(0);
+    const IRValue *rhs = inst->operand(1);
+    // 可交换的运算把常量换到右边
+    bool commutative = inst->op == Opcode::ADD || inst->op == Opcode::MUL ||
+                       inst->op == Opcode::AND || inst->op == Opcode::OR ||
+                       inst->op == Opcode::XOR || inst->op == Opcode::EQ ||
+                       inst->op == Opcode::NE;
+    if (commutative && isa<IRInteger>(lhs) && !isa<IRInteger>(rhs))
+        std::swap(lhs, rhs);
+    if (const IRInteger *imm = dyn_cast<IRInteger>(rhs)) {
+        if (generate_binary_imm(inst->op, lhs, imm->value, out)) {
+            access_stack("sw", "t2", inst->id, out);
+            return;
         }
     }
-    int total_stack_size = (stack_offset + 15) & ~15; // 16 字节对齐
-    if (total_stack_size > 0) {
-        out << "  lw ra, " << (total_stack_size - 4)
-            << "(sp)\n";                                      // 恢复返回地址
-        out << "  addi sp, sp, " << total_stack_size << "\n"; // 释放栈空间
-    }
-    out << "  ret\n";
-}
-
-// 访问 integer
-void generate_riscv(const koopa_raw_integer_t &integer, std::ostream &out) {
-    out << "  li a0, " << integer.value << "\n";
-}
-
-// 加载操作数到寄存器
-void load_operand(const koopa_raw_value_t &operand, const char *reg,
-                  std::ostream &out) {
-    if (operand->kind.tag == KOOPA_RVT_INTEGER) {
-        out << "  li " << reg << ", " << operand->kind.data.integer.value
-            << "\n";
-    } else {
-        int offset = get_stack_offset(operand);
-        out << "  lw " << reg << ", " << offset << "(sp)\n";
-    }
-}
-
-// 访问 binary 指令
-void generate_riscv(const koopa_raw_binary_t &binary,
-                    const koopa_raw_value_t &value, std::ostream &out) {
-    koopa_raw_value_t lhs = binary.lhs;
-    koopa_raw_value_t rhs = binary.rhs;
-
-    // 为结果分配栈空间
-    int result_offset = get_stack_offset(value); // 应该已经在函数入口分配
 
-    // 加载左操作数到 t0
     load_operand(lhs, "t0", out);
-
-    // 加载右操作数到 t1
     load_operand(rhs, "t1", out);
-
-    // 根据操作符生成 RISC-V 指令
-    switch (binary.op) {
-    case KOOPA_RBO_ADD:
+    switch (inst->op) {
+    case Opcode::ADD:
         out << "  add t2, t0, t1\n";
         break;
-    case KOOPA_RBO_SUB:
+    case Opcode::SUB:
         out << "  sub t2, t0, t1\n";
         break;
-    case KOOPA_RBO_MUL:
+    case Opcode::MUL:
         out << "  mul t2, t0, t1\n";
         break;
-    case KOOPA_RBO_DIV:
+    case Opcode::DIV:
         out << "  div t2, t0, t1\n";
         break;
-    case KOOPA_RBO_MOD:
+    case Opcode::MOD:
         out << "  rem t2, t0, t1\n";
         break;
-    case KOOPA_RBO_AND:
+    case Opcode::AND:
         out << "  and t2, t0, t1\n";
         break;
-    case KOOPA_RBO_OR:
+    case Opcode::OR:
         out << "  or t2, t0, t1\n";
         break;
-    case KOOPA_RBO_EQ:
+    case Opcode::XOR:
+        out << "  xor t2, t0, t1\n";
+        break;
+    case Opcode::SHL:
+        out << "  sll t2, t0, t1\n";
+        break;
+    case Opcode::SHR:
+        out << "  srl t2, t0, t1\n";
+        break;
+    case Opcode::SAR:
+        out << "  sra t2, t0, t1\n";
+        break;
+    case Opcode::EQ:
         out << "  sub t2, t0, t1\n"; // t2 = t0 - t1
         out << "  seqz t2, t2\n";    // t2 = (t2 == 0) ? 1 : 0
         break;
-    case KOOPA_RBO_NOT_EQ:
+    case Opcode::NE:
         out << "  sub t2, t0, t1\n"; // t2 = t0 - t1
         out << "  snez t2, t2\n";    // t2 = (t2 != 0) ? 1 : 0
         break;
-    case KOOPA_RBO_GT:
+    case Opcode::GT:
         out << "  sgt t2, t0, t1\n"; // t2 = (t0 > t1) ? 1 : 0
         break;
-    case KOOPA_RBO_LT:
+    case Opcode::LT:
         out << "  slt t2, t0, t1\n"; // t2 = (t0 < t1) ? 1 : 0
         break;
-    case KOOPA_RBO_GE:
+    case Opcode::GE:
         out << "  slt t2, t0, t1\n"; // t2 = (t0 < t1) ? 1 : 0
         out << "  xori t2, t2, 1\n"; // t2 = !t2 (t0 >= t1)
         break;
-    case KOOPA_RBO_LE:
+    case Opcode::LE:
         out << "  sgt t2, t0, t1\n"; // t2 = (t0 > t1) ? 1 : 0
         out << "  xori t2, t2, 1\n"; // t2 = !t2 (t0 <= t1)
         break;
     default:
-        assert(false); // 未处理的操作符
+        assert(false); // 不是二元运算
+    }
+    access_stack("sw", "t2", inst->id, out);
+}
+
+static void generate_call(const IRInst *inst, OutputBuffer &out) {
+    // 前 8 个实参放在 a0-a7，其余依次放在栈顶
+    for (uint32_t i = 0; i < inst->num_operands; ++i) {
+        if (i < 8) {
+            load_operand(inst->operand(i), arg_regs[i], out);
+        } else {
+            load_operand(inst->operand(i), "t0", out);
+            access_stack("sw", "t0", (i - 8) * 4, out);
+        }
+    }
+    out << "  call " << inst->callee->name << "\n";
+    if (!inst->type->isUnit())
+        access_stack("sw", "a0", inst->id, out);
+}
+
+static void generate_return(const IRInst *inst, OutputBuffer &out) {
+    if (inst->num_operands)
+        load_operand(inst->operand(0), "a0", out);
+    if (frame.saves_ra)
+        access_stack("lw", "ra", frame.size - 4, out); // 恢复返回地址
+    if (frame.size > 0)
+        adjust_sp(frame.size, out); // 释放栈空间
+    out << "  ret\n";
+}
+
+// 比较结果取反后的比较：!(a < b) 即 a >= b
+static Opcode negate_compare(Opcode op) {
+    switch (op) {
+    case Opcode::NE:
+        return Opcode::EQ;
+    case Opcode::EQ:
+        return Opcode::NE;
+    case Opcode::GT:
+        return Opcode::LE;
+    case Opcode::LT:
+        return Opcode::GE;
+    case Opcode::GE:
+        return Opcode::LT;
+    default:
+        return Opcode::GT;
+    }
+}
+
+// 交换两个操作数后的比较：a < b 即 b > a
+static Opcode swap_compare(Opcode op) {
+    switch (op) {
+    case Opcode::GT:
+        return Opcode::LT;
+    case Opcode::LT:
+        return Opcode::GT;
+    case Opcode::GE:
+        return Opcode::LE;
+    case Opcode::LE:
+        return Opcode::GE;
+    default:
+        return op; // eq/ne
+    }
+}
+
+static bool is_zero(const IRValue *value) {
+    const IRInteger *constant = dyn_cast<IRInteger>(value);
+    return constant && constant->value == 0;
+}
+
+// 沿 inst 的第 t 条出边把实参写入目标块参数的槽。这是一组并行赋值：
+// 实参可能正是目标块的另一个参数（循环回边上常见），先写入的槽不能被
+// 之后的赋值再读到。每次挑一个目标槽不再被其余赋值读取的先做；
+// 剩下的都成环时，把一个目标槽的旧值暂存到 t4 再继续
+static void generate_edge_copies(const IRInst *inst, uint32_t t,
+                                 OutputBuffer &out) {
+    const IRBlock *target = inst->targets[t];
+    uint32_t begin = inst->targetArgBegin(t);
+    struct Copy {
+        const IRValue *src; // 为空表示 t4
+        const IRValue *dst;
+    };
+    std::vector<Copy> copies;
+    for (uint32_t i = 0; i < target->num_args; ++i) {
+        const IRValue *src = inst->operand(begin + i);
+        if (src != target->args[i]) // 参数原样传回自己时不用复制
+            copies.push_back({src, target->args[i]});
+    }
+    while (!copies.empty()) {
+        size_t ready = copies.size();
+        for (size_t i = 0; i < copies.size() && ready == copies.size(); ++i) {
+            bool read = false;
+            for (const Copy &other : copies)
+                read = read || other.src == copies[i].dst;
+            if (!read)
+                ready = i;
+        }
+        if (ready == copies.size()) { // 都在环上：暂存第一个目标槽的旧值
+            const IRValue *saved = copies[0].dst;
+            access_stack("lw", "t4", saved->id, out);
+            for (Copy &copy : copies)
+                if (copy.src == saved)
+                    copy.src = nullptr;
+            ready = 0;
+        }
+        const Copy &copy = copies[ready];
+        if (copy.src) {
+            load_operand(copy.src, "t0", out);
+            access_stack("sw", "t0", copy.dst->id, out);
+        } else {
+            access_stack("sw", "t4", copy.dst->id, out);
+        }
+        copies.erase(copies.begin() + ready);
+    }
+}
+
+// 沿第 t 条出边离开：复制实参后跳转。目标紧跟在后面、
+// 并且允许落入（may_fall_through）时不必跳转
+static void generate_edge(const IRInst *inst, uint32_t t, OutputBuffer &out,
+                          bool may_fall_through = true) {
+    generate_edge_copies(inst, t, out);
+    if (!may_fall_through || inst->targets[t] != inst->parent->next) {
+        out << "  j ";
+        print_label(inst->targets[t], out);
+        out << "\n";
+    }
+}
+
+// br cond, then, else。cond 是融合的比较时直接按比较跳转，
+// 否则按 cond != 0 跳转。条件跳转只能直接去往没有参数的目标，
+// 另一条出边的实参复制放在条件跳转之后；两个目标都有参数时，
+// 条件跳转先去往一个局部标号，在那里复制实参后再跳转
+static void generate_branch(const IRInst *inst, OutputBuffer &out) {
+    static const char *const branch[] = {"bne", "beq", "bgt",
+                                         "blt", "bge", "ble"};
+    static const char *const branch_zero[] = {"bnez", "beqz", "bgtz",
+                                              "bltz", "bgez", "blez"};
+    static int edge_labels = 0; // 局部标号 edge_N，在整个输出中唯一
+    const IRValue *lhs = inst->operand(0);
+    const IRValue *rhs = nullptr; // 为空表示与 0 比较
+    Opcode op = Opcode::NE;
+    const IRInst *cmp = dyn_cast<IRInst>(lhs);
+    if (cmp && is_fused_compare(cmp)) {
+        op = cmp->op;
+        lhs = cmp->operand(0);
+        rhs = cmp->operand(1);
+        if (is_zero(rhs)) {
+            rhs = nullptr;
+        } else if (is_zero(lhs)) {
+            lhs = rhs;
+            rhs = nullptr;
+            op = swap_compare(op);
+        }
+    }
+
+    // taken 是条件跳转去往的出边，另一条出边接在后面
+    uint32_t taken = 0;
+    const IRBlock *then_block = inst->targets[0];
+    const IRBlock *else_block = inst->targets[1];
+    if (then_block->num_args ||
+        (!else_block->num_args && then_block == inst->parent->next)) {
+        taken = 1; // 条件取反跳到 else
+        op = negate_compare(op);
+    }
+    int index = static_cast<int>(op);
+    load_operand(lhs, "t0", out);
+    if (rhs) {
+        load_operand(rhs, "t1", out);
+        out << "  " << branch[index] << " t0, t1, ";
+    } else {
+        out << "  " << branch_zero[index] << " t0, ";
+    }
+    int edge_label = -1;
+    if (inst->targets[taken]->num_args) {
+        edge_label = edge_labels++;
+        out << "edge_" << edge_label;
+    } else {
+        print_label(inst->targets[taken], out);
+    }
+    out << "\n";
+    // 后面还有局部标号时不能落入下一个块
+    generate_edge(inst, 1 - taken, out, edge_label < 0);
+    if (edge_label >= 0) {
+        out << "edge_" << edge_label << ":\n";
+        generate_edge(inst, taken, out);
+    }
+}
+
+static void generate_inst(const IRInst *inst, OutputBuffer &out) {
+    if (is_fused_compare(inst))
+        return; // 在使用它的 br 处生成
+    if (inst->isBinary()) {
+        generate_binary(inst, out);
+        return;
+    }
+    switch (inst->op) {
+    case Opcode::ALLOC:
+        // 变量就存放在 alloc 自己的槽中，函数入口已经分配好了
+        break;
+    case Opcode::LOAD:
+        assert(isa<IRInst>(inst->operand(0)) &&
+               cast<IRInst>(inst->operand(0))->op == Opcode::ALLOC);
+        access_stack("lw", "t0", inst->operand(0)->id, out);
+        access_stack("sw", "t0", inst->id, out);
+        break;
+    case Opcode::STORE:
+        load_operand(inst->operand(0), "t0", out);
+        access_stack("sw", "t0", inst->operand(1)->id, out);
+        break;
+    case Opcode::CALL:
+        generate_call(inst, out);
+        break;
+    case Opcode::BR:
+        generate_branch(inst, out);
+        break;
+    case Opcode::JUMP:
+        generate_edge(inst, 0, out);
+        break;
+    case Opcode::RET:
+        generate_return(inst, out);
+        break;
+    default:
+        assert(false); // 未处理的指令类型
     }
+}
+
+void generate_riscv_function(IRFunction *func, OutputBuffer &out) {
+    out << "  .globl " << func->name << "\n";
+    out << func->name << ":\n";
 
-    // 将结果存入栈
-    out << "  sw t2, " << result_offset << "(sp)\n";
+    layout_frame(func);
+    if (frame.size > 0)
+        adjust_sp(-frame.size, out);
+    if (frame.saves_ra)
+        access_stack("sw", "ra", frame.size - 4, out); // 保存返回地址
+    // 参数存入各自的槽，之后调用其他函数时 a0-a7 可以被覆盖
+    for (uint32_t i = 0; i < func->num_args; ++i) {
+        if (i < 8) {
+            access_stack("sw", arg_regs[i], func->args[i]->id, out);
+        } else {
+            access_stack("lw", "t0", frame.size + (i - 8) * 4, out);
+            access_stack("sw", "t0", func->args[i]->id, out);
+        }
+    }
+
+    for (IRBlock *block : blocks(func)) {
+        // 入口块不会是跳转目标，函数名就是它的标号
+        if (block != func->entry()) {
+            print_label(block, out);
+            out << ":\n";
+        }
+        for (IRInst *inst : insts(block))
+            generate_inst(inst, out);
+    }
+}
+
+void generate_riscv(IRModule &module, OutputBuffer &out) {
+    out << "  .text\n";
+    for (IRFunction *func : module.functions())
+        if (!func->isDeclaration()) // 库函数由运行时提供
+            generate_riscv_function(func, out);
 }
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "mem2reg.hpp"
+#include "cfg.hpp"
+#include <utility>
+#include <vector>
+
+namespace {
+
+// 可以提升的 alloc 在 IRValue::id 中记录它在 allocs 中的下标，其余为 -1
+class Mem2Reg {
+public:
+    Mem2Reg(IRModule &module, IRFunction *func)
+        : module(module), func(func), dom(func) {
+    }
+    int run();
+
+private:
+    static bool promotable(const IRInst *alloc);
+    // 被提升的变量的下标；inst 不是 load / store 被提升的变量时为 -1
+    static int variableOf(const IRInst *inst);
+    void collect();
+    void placeBlockArgs();
+    void rename();
+    void renameBlock(IRBlock *block);
+    void rewriteTerminator(IRInst *term);
+    void setCurrent(int var, IRValue *value) {
+        undo.push_back({var, current[var]});
+        current[var] = value;
+    }
+
+    IRModule &module;
+    IRFunction *func;
+    DominatorTree dom;
+    std::vector<IRInst *> allocs;
+    // 各变量被 store 的块，以及入口处就被读取（读在写之前）的块
+    std::vector<std::vector<IRBlock *>> def_blocks, use_blocks;
+    std::vector<std::vector<int>> arg_vars; // 各块参数对应的变量，按块编号
+    std::vector<IRValue *> current;         // 重命名时各变量的当前值
+    std::vector<std::pair<int, IRValue *>> undo; // 离开子树时恢复的旧值
+};
+
+bool Mem2Reg::promotable(const IRInst *alloc) {
+    if (alloc->type->base->kind != IRType::I32)
+        return false;
+    for (const IRUse *use = alloc->uses; use; use = use->next) {
+        const IRInst *user = use->user;
+        bool is_load = user->op == Opcode::LOAD;
+        bool is_store_address =
+            user->op == Opcode::STORE && use == &user->operands[1];
+        if (!is_load && !is_store_address)
+            return false;
+    }
+    return true;
+}
+
+int Mem2Reg::variableOf(const IRInst *inst) {
+    if (inst->op != Opcode::LOAD && inst->op != Opcode::STORE)
+        return -1;
+    const IRInst *address =
+        dyn_cast<IRInst>(inst->operand(inst->op == Opcode::LOAD ? 0 : 1));
+    return address && address->op == Opcode::ALLOC ? address->id : -1;
+}
+
+void Mem2Reg::collect() {
+    for (IRBlock *block : dom.blocks()) {
+        for (IRInst *inst : insts(block)) {
+            if (inst->op != Opcode::ALLOC)
+                continue;
+            inst->id = -1;
+            if (promotable(inst)) {
+                inst->id = static_cast<int>(allocs.size());
+                allocs.push_back(inst);
+            }
+        }
+    }
+    def_blocks.resize(allocs.size());
+    use_blocks.resize(allocs.size());
+    // 按块内顺序扫描，各块只记一次。store 之前的 load 说明变量在入口处活跃
+    std::vector<IRBlock *> last_def(allocs.size(), nullptr);
+    std::vector<IRBlock *> last_use(allocs.size(), nullptr);
+    for (IRBlock *block : dom.blocks()) {
+        for (IRInst *inst : insts(block)) {
+            int var = variableOf(inst);
+            if (var < 0)
+                continue;
+            if (inst->op == Opcode::STORE) {
+                if (last_def[var] != block)
+                    def_blocks[var].push_back(block);
+                last_def[var] = block;
+            } else if (last_def[var] != block && last_use[var] != block) {
+                use_blocks[var].push_back(block);
+                last_use[var] = block;
+            }
+        }
+    }
+}
+
+void Mem2Reg::placeBlockArgs() {
+    std::vector<std::vector<IRBlock *>> frontiers = dom.frontiers();
+    size_t n = dom.blocks().size();
+    arg_vars.resize(n);
+    // 按变量打的标记，换一个变量时不必清空
+    std::vector<int> is_def(n, -1), is_live(n, -1), has_arg(n, -1);
+    std::vector<IRBlock *> worklist;
+    for (int var = 0; var < static_cast<int>(allocs.size()); ++var) {
+        for (IRBlock *block : def_blocks[var])
+            is_def[block->id] = var;
+
+        // 活跃性：从入口处读取的块沿前驱向上，到定义块为止
+        worklist = use_blocks[var];
+        for (IRBlock *block : worklist)
+            is_live[block->id] = var;
+        while (!worklist.empty()) {
+            IRBlock *block = worklist.back();
+            worklist.pop_back();
+            for (IRBlock *pred : dom.preds(block)) {
+                if (is_live[pred->id] == var || is_def[pred->id] == var)
+                    continue;
+                is_live[pred->id] = var;
+                worklist.push_back(pred);
+            }
+        }
+
+        // 迭代支配边界。新加的参数也是一次定义
+        worklist = def_blocks[var];
+        while (!worklist.empty()) {
+            IRBlock *block = worklist.back();
+            worklist.pop_back();
+            for (IRBlock *frontier : frontiers[block->id]) {
+                if (has_arg[frontier->id] == var)
+                    continue;
+                has_arg[frontier->id] = var;
+                if (is_live[frontier->id] == var) {
+                    IRBlockArg *arg =
+                        module.addBlockArg(frontier, module.i32Type());
+                    arg->name = allocs[var]->name;
+                    arg_vars[frontier->id].push_back(var);
+                }
+                if (is_def[frontier->id] != var)
+                    worklist.push_back(frontier);
+            }
+        }
+    }
+}
+
+void Mem2Reg::rewriteTerminator(IRInst *term) {
+    std::vector<IRValue *> args[2];
+    bool has_args = false;
+    for (uint32_t t = 0; t < term->numTargets(); ++t) {
+        for (int var : arg_vars[term->targets[t]->id])
+            args[t].push_back(current[var]);
+        has_args = has_args || !args[t].empty();
+    }
+    if (has_args)
+        rebuild_branch(module, term, args);
+}
+
+void Mem2Reg::renameBlock(IRBlock *block) {
+    const std::vector<int> &vars = arg_vars[block->id];
+    for (size_t i = 0; i < vars.size(); ++i)
+        setCurrent(vars[i], block->args[i]);
+    for (IRInst *inst : insts(block)) {
+        int var = variableOf(inst);
+        if (var >= 0) {
+            if (inst->op == Opcode::LOAD)
+                inst->replaceAllUsesWith(current[var]);
+            else
+                setCurrent(var, inst->operand(0));
+            inst->eraseFromParent();
+        } else if (inst->op == Opcode::BR || inst->op == Opcode::JUMP) {
+            rewriteTerminator(inst);
+        }
+    }
+}
+
+// 沿支配树非递归先序遍历，离开子树时按 undo 恢复各变量的当前值
+void Mem2Reg::rename() {
+    current.assign(allocs.size(), module.integer(0));
+    struct Frame {
+        IRBlock *block;
+        size_t undo_size;
+        size_t next_child;
+    };
+    std::vector<Frame> stack;
+    stack.push_back({func->entry(), undo.size(), 0});
+    renameBlock(func->entry());
+    while (!stack.empty()) {
+        Frame &top = stack.back();
+        const std::vector<IRBlock *> &children = dom.children(top.block);
+        if (top.next_child < children.size()) {
+            IRBlock *child = children[top.next_child++];
+            stack.push_back({child, undo.size(), 0});
+            renameBlock(child);
+            continue;
+        }
+        while (undo.size() > top.undo_size) {
+            current[undo.back().first] = undo.back().second;
+            undo.pop_back();
+        }
+        stack.pop_back();
+    }
+}
+
+int Mem2Reg::run() {
+    collect();
+    if (allocs.empty())
+        return 0;
+    placeBlockArgs();
+    rename();
+    for (IRInst *alloc : allocs)
+        alloc->eraseFromParent();
+    return static_cast<int>(allocs.size());
+}
+
+} // namespace
+
+int promote_memory_to_registers(IRModule &module, IRFunction *func) {
+    if (func->isDeclaration())
+        return 0;
+    remove_unreachable_blocks(func);
+    return Mem2Reg(module, func).run();
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "ir.hpp"
+
+// mem2reg：把局部变量从栈上的 alloc 提升为 SSA 值。
+// 只被 load 读取、被 store 写入（不作为值传出去）的 alloc i32 都可以提升。
+// 先删除不可达的基本块，再在各变量 store 所在块的迭代支配边界中、
+// 变量在入口处活跃的块上添加基本块参数（代替 phi），然后沿支配树重命名：
+// load 换成当前值，store 更新当前值，跳转指令补上传给目标块的实参。
+// 最后删掉这些 load、store 和 alloc。没有赋值就读取的变量取 0。
+// 返回提升的 alloc 个数
+int promote_memory_to_registers(IRModule &module, IRFunction *func);
@@ -0,0 +1,123 @@
+#include "name_binding.hpp"
+#include <iostream>
+
+bool NameBinder::enterFuncDef(FuncDefAST *node) {
+    // 获取返回类型和参数类型列表（语法保证了各层节点的类型）
+    std::string return_type = cast<FuncTypeAST>(node->func_type.get())->type;
+    std::vector<std::string> param_types;
+    if (node->func_params) {
+        for (const auto &param :
+             cast<FuncFParamsAST>(node->func_params.get())->params) {
+            const FuncFParamAST *param_ast = cast<FuncFParamAST>(param.get());
+            param_types.push_back(
+                cast<BTypeAST>(param_ast->btype.get())->type);
+        }
+    }
+    // 先登记函数再处理函数体，函数体中可以递归调用自己
+    node->func = symTab.addFunction(node->ident, return_type, param_types);
+    func = node;
+    node->num_slots = 0;
+
+    // 参数位于函数自己的作用域，函数体 Block 再嵌套一层
+    symTab.enterScope();
+    if (node->func_params) {
+        for (const auto &param :
+             cast<FuncFParamsAST>(node->func_params.get())->params) {
+            FuncFParamAST *param_ast = cast<FuncFParamAST>(param.get());
+            param_ast->slot = node->num_slots++;
+            symTab.addVariable(param_ast->ident, param_ast, false, true);
+        }
+    }
+    return true;
+}
+
+void NameBinder::leaveFuncDef(FuncDefAST *) {
+    symTab.exitScope();
+}
+
+bool NameBinder::enterBlock(BlockAST *) {
+    symTab.enterScope();
+    return true;
+}
+
+void NameBinder::leaveBlock(BlockAST *) {
+    symTab.exitScope();
+}
+
+// 声明先登记再处理初始值，初始值中的同名引用指向新声明的变量
+bool NameBinder::enterConstDef(ConstDefAST *node) {
+    node->slot = func->num_slots++;
+    symTab.addVariable(node->ident, node, true, false);
+    return true;
+}
+
+bool NameBinder::enterVarDef(VarDefAST *node) {
+    node->slot = func->num_slots++;
+    symTab.addVariable(node->ident, node, false, false);
+    return true;
+}
+
+bool NameBinder::enterLVal(LValAST *node) {
+    const SymbolTable::Symbol *symbol = symTab.findVariable(node->ident);
+    if (!symbol) {
+        std::cerr << "Error: Undefined variable '" << interner.str(node->ident)
+                  << "'\n";
+        ++num_errors;
+        return false;
+    }
+    node->decl = symbol->decl;
+    return false;
+}
+
+bool NameBinder::enterCallExp(CallExpAST *node) {
+    node->callee = symTab.findFunction(node->ident);
+    if (!node->callee) {
+        std::cerr << "错误: 函数 '" << interner.str(node->ident)
+                  << "' 未定义\n";
+        ++num_errors;
+    }
+    return true;
+}
+
+bool NameBinder::enterStmt(StmtAST *node) {
+    switch (node->kind) {
+    case StmtAST::StmtKind::WHILE:
+        // 条件表达式中不会出现 break/continue，进入时就可以压栈
+        loops.push_back(node);
+        break;
+    case StmtAST::StmtKind::BREAK:
+    case StmtAST::StmtKind::CONTINUE:
+        if (loops.empty()) {
+            std::cerr << "Error: "
+                      << (node->kind == StmtAST::StmtKind::BREAK ? "break"
+                                                                 : "continue")
+                      << " statement outside of loop\n";
+            ++num_errors;
+            break;
+        }
+        node->loop = loops.back();
+        if (node->kind == StmtAST::StmtKind::BREAK)
+            node->loop->has_break = true;
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+void NameBinder::leaveStmt(StmtAST *node) {
+    if (node->kind == StmtAST::StmtKind::WHILE) {
+        loops.pop_back();
+    } else if (node->kind == StmtAST::StmtKind::ASSIGN) {
+        // 被赋值的参数在 IR 中需要一个栈槽，其余参数直接当作值使用
+        BaseAST *decl = cast<LValAST>(node->lval.get())->decl;
+        if (FuncFParamAST *param = dyn_cast<FuncFParamAST>(decl))
+            param->assigned = true;
+    }
+}
+
+bool bind_names(BaseAST *root) {
+    NameBinder binder;
+    binder.walk(root);
+    return binder.errors() == 0;
+}
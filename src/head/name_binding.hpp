@@ -0,0 +1,37 @@
+#pragma once
+#include "visitor.hpp"
+#include <vector>
+
+// 名字绑定遍：按作用域规则把每个 LVal 绑定到它的声明节点，
+// 把每个函数调用绑定到 symTab 中的函数，把 break/continue 绑定到所属的 while。
+// 结果写在 LValAST::decl、CallExpAST::callee 和 StmtAST::loop 上，
+// 被赋值的参数记在 FuncFParamAST::assigned 上。参数和局部变量在所属函数中
+// 依次编号（slot），之后各遍按编号而不是名字查找。
+// 库函数需要在此之前登记到 symTab 中。
+// 未定义的变量、函数和循环外的 break/continue 输出错误并计数，相应的
+// 结果字段保持为空，之后的遍不能再运行。
+class NameBinder : public ASTVisitor<NameBinder> {
+public:
+    bool enterFuncDef(FuncDefAST *node);
+    void leaveFuncDef(FuncDefAST *node);
+    bool enterBlock(BlockAST *node);
+    void leaveBlock(BlockAST *node);
+    bool enterConstDef(ConstDefAST *node);
+    bool enterVarDef(VarDefAST *node);
+    bool enterLVal(LValAST *node);
+    bool enterCallExp(CallExpAST *node);
+    bool enterStmt(StmtAST *node);
+    void leaveStmt(StmtAST *node);
+
+    int errors() const {
+        return num_errors;
+    }
+
+private:
+    FuncDefAST *func = nullptr;   // 当前函数
+    std::vector<StmtAST *> loops; // 外层到内层的 while 语句
+    int num_errors = 0;
+};
+
+// 没有错误时返回 true
+bool bind_names(BaseAST *root);
@@ -0,0 +1,81 @@
+#include "output_buffer.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <new>
+#include <unistd.h>
+
+OutputBuffer::~OutputBuffer() {
+    close();
+    free(begin);
+}
+
+bool OutputBuffer::open(const char *path) {
+    close();
+    fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+    // 文件模式使用固定大小的缓冲区，之前内存模式的内容丢弃
+    free(begin);
+    begin = static_cast<char *>(malloc(kFileBufferSize));
+    if (!begin)
+        throw std::bad_alloc();
+    cur = begin;
+    limit = begin + kFileBufferSize;
+    ok = true;
+    return true;
+}
+
+bool OutputBuffer::close() {
+    if (fd < 0)
+        return true;
+    flush();
+    if (::close(fd) != 0)
+        ok = false;
+    fd = -1;
+    return ok;
+}
+
+// 把缓冲区的内容整体写到文件，短写时继续写剩下的部分
+bool OutputBuffer::flush() {
+    const char *p = begin;
+    while (p < cur) {
+        ssize_t n = ::write(fd, p, cur - p);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            ok = false;
+            break;
+        }
+        p += n;
+    }
+    cur = begin;
+    return ok;
+}
+
+// 写入 len 字节前空间不够时调用：文件模式先写出缓冲区，
+// 内存模式（以及单次写入超过整个缓冲区时）按倍数扩容
+void OutputBuffer::make_room(size_t len) {
+    if (fd >= 0) {
+        flush();
+        if (static_cast<size_t>(limit - cur) >= len)
+            return;
+    }
+    size_t used = cur - begin;
+    size_t cap = begin ? limit - begin : kInitialSize;
+    while (cap - used < len)
+        cap *= 2;
+    char *grown = static_cast<char *>(realloc(begin, cap));
+    if (!grown)
+        throw std::bad_alloc();
+    begin = grown;
+    cur = begin + used;
+    limit = begin + cap;
+}
+
+const char *OutputBuffer::c_str() {
+    if (cur == limit)
+        make_room(1);
+    *cur = '\0';
+    return begin;
+}
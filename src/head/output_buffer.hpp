@@ -0,0 +1,77 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// IR / 汇编输出缓冲：代替 std::ostream，只支持生成代码用到的几种写入。
+// 整数用 std::to_chars 转换，不经过 locale 和 sentry；文本直接 memcpy
+// 到预分配的大缓冲区。两种模式：
+//   - 文件模式（open 之后）：缓冲区写满时整块 write 到文件，close 时写出剩余
+//     部分，内存占用固定；
+//   - 内存模式（默认）：缓冲区按倍数增长，输出完后用 view()/c_str() 读取。
+class OutputBuffer {
+public:
+    OutputBuffer() = default;
+    OutputBuffer(const OutputBuffer &) = delete;
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+    ~OutputBuffer();
+
+    // 打开输出文件，之后进入文件模式，失败时返回 false
+    bool open(const char *path);
+    // 写出剩余内容并关闭文件，所有写入都成功时返回 true
+    bool close();
+
+    OutputBuffer &write(const char *data, size_t len) {
+        if (static_cast<size_t>(limit - cur) < len)
+            make_room(len);
+        memcpy(cur, data, len);
+        cur += len;
+        return *this;
+    }
+    OutputBuffer &operator<<(const char *s) {
+        return write(s, strlen(s));
+    }
+    OutputBuffer &operator<<(std::string_view s) {
+        return write(s.data(), s.size());
+    }
+    OutputBuffer &operator<<(const std::string &s) {
+        return write(s.data(), s.size());
+    }
+    OutputBuffer &operator<<(char c) {
+        if (cur == limit)
+            make_room(1);
+        *cur++ = c;
+        return *this;
+    }
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    OutputBuffer &operator<<(T value) {
+        // 64 位整数的十进制表示（含符号）最多 20 个字符
+        if (limit - cur < 24)
+            make_room(24);
+        cur = std::to_chars(cur, limit, value).ptr;
+        return *this;
+    }
+
+    // 内存模式下读取已输出的内容
+    std::string_view view() const {
+        return std::string_view(begin, cur - begin);
+    }
+    // 以 '\0' 结尾的内容，可以直接交给 koopa_parse_from_string
+    const char *c_str();
+
+private:
+    void make_room(size_t len);
+    bool flush();
+
+    static constexpr size_t kFileBufferSize = 4 << 20;
+    static constexpr size_t kInitialSize = 1 << 16;
+
+    char *begin = nullptr;
+    char *cur = nullptr;
+    char *limit = nullptr;
+    int fd = -1;     // -1 表示内存模式
+    bool ok = true; // 文件模式下是否有写入失败
+};
@@ -0,0 +1,222 @@
+#include "sccp.hpp"
+#include "cfg.hpp"
+#include <vector>
+
+namespace {
+
+// 基本块按顺序编号，基本块参数和指令按顺序编号，编号存放在各自的 id 中
+class SCCP {
+public:
+    SCCP(IRModule &module, IRFunction *func) : module(module), func(func) {
+    }
+    void run();
+
+private:
+    enum class State : uint8_t { UNDEF, CONST, OVERDEFINED };
+    struct Lattice {
+        State state = State::UNDEF;
+        int32_t value = 0; // CONST 时的值
+        bool operator!=(const Lattice &o) const {
+            return state != o.state || value != o.value;
+        }
+    };
+    static Lattice meet(Lattice a, Lattice b);
+    Lattice get(const IRValue *value) const;
+    Lattice evaluate(const IRInst *inst) const;
+    // 格值只会下降：与原来的值取交，有变化时把 value 加入工作表
+    void update(IRValue *value, Lattice lattice);
+    void markExecutable(IRBlock *block);
+    void visit(IRInst *inst);
+    void visitEdge(IRInst *term, uint32_t t);
+    void rewrite();
+
+    IRModule &module;
+    IRFunction *func;
+    std::vector<Lattice> lattices; // 基本块参数和指令的格值
+    std::vector<bool> executable;  // 各基本块是否可执行
+    std::vector<IRBlock *> block_worklist;
+    std::vector<IRValue *> value_worklist;
+};
+
+SCCP::Lattice SCCP::meet(Lattice a, Lattice b) {
+    if (a.state == State::UNDEF)
+        return b;
+    if (b.state == State::UNDEF)
+        return a;
+    if (a.state == State::CONST && b.state == State::CONST &&
+        a.value == b.value)
+        return a;
+    return {State::OVERDEFINED, 0};
+}
+
+SCCP::Lattice SCCP::get(const IRValue *value) const {
+    switch (value->value_kind) {
+    case IRValueKind::INTEGER:
+        return {State::CONST, cast<IRInteger>(value)->value};
+    case IRValueKind::ARGUMENT:
+        return {State::OVERDEFINED, 0};
+    default:
+        return lattices[value->id];
+    }
+}
+
+SCCP::Lattice SCCP::evaluate(const IRInst *inst) const {
+    Lattice lhs = get(inst->operand(0));
+    Lattice rhs = get(inst->operand(1));
+    if (lhs.state == State::OVERDEFINED || rhs.state == State::OVERDEFINED)
+        return {State::OVERDEFINED, 0};
+    if (lhs.state == State::UNDEF || rhs.state == State::UNDEF)
+        return {};
+    if (std::optional<int32_t> value =
+            fold_binary(inst->op, lhs.value, rhs.value))
+        return {State::CONST, *value};
+    return {State::OVERDEFINED, 0}; // 除零等留到运行时
+}
+
+void SCCP::update(IRValue *value, Lattice lattice) {
+    Lattice &current = lattices[value->id];
+    Lattice lowered = meet(current, lattice);
+    if (lowered != current) {
+        current = lowered;
+        value_worklist.push_back(value);
+    }
+}
+
+void SCCP::markExecutable(IRBlock *block) {
+    if (executable[block->id])
+        return;
+    executable[block->id] = true;
+    block_worklist.push_back(block);
+}
+
+// 边 term -> targets[t] 可执行：实参流入目标块的参数
+void SCCP::visitEdge(IRInst *term, uint32_t t) {
+    IRBlock *target = term->targets[t];
+    uint32_t begin = term->targetArgBegin(t);
+    for (uint32_t i = 0; i < target->num_args; ++i)
+        update(target->args[i], get(term->operand(begin + i)));
+    markExecutable(target);
+}
+
+void SCCP::visit(IRInst *inst) {
+    if (inst->isBinary()) {
+        update(inst, evaluate(inst));
+        return;
+    }
+    switch (inst->op) {
+    case Opcode::ALLOC:
+    case Opcode::LOAD:
+    case Opcode::CALL:
+        if (!inst->type->isUnit())
+            update(inst, {State::OVERDEFINED, 0});
+        break;
+    case Opcode::BR: {
+        Lattice cond = get(inst->operand(0));
+        if (cond.state == State::CONST) {
+            visitEdge(inst, cond.value != 0 ? 0 : 1);
+        } else if (cond.state == State::OVERDEFINED) {
+            visitEdge(inst, 0);
+            visitEdge(inst, 1);
+        }
+        break;
+    }
+    case Opcode::JUMP:
+        visitEdge(inst, 0);
+        break;
+    default: // store、ret
+        break;
+    }
+}
+
+void SCCP::rewrite() {
+    for (IRBlock *block : blocks(func)) {
+        if (!executable[block->id])
+            continue;
+        for (uint32_t i = 0; i < block->num_args; ++i) {
+            Lattice lattice = get(block->args[i]);
+            if (lattice.state == State::CONST)
+                block->args[i]->replaceAllUsesWith(
+                    module.integer(lattice.value));
+        }
+        for (IRInst *inst : insts(block)) {
+            if (!inst->isBinary() || get(inst).state != State::CONST)
+                continue;
+            inst->replaceAllUsesWith(module.integer(get(inst).value));
+            inst->eraseFromParent();
+        }
+    }
+    // 条件已经换成常量的 br 只保留可执行的那条边
+    for (IRBlock *block : blocks(func)) {
+        IRInst *term = block->terminator();
+        if (!executable[block->id] || !term || term->op != Opcode::BR)
+            continue;
+        const IRInteger *cond = dyn_cast<IRInteger>(term->operand(0));
+        if (!cond)
+            continue;
+        uint32_t t = cond->value != 0 ? 0 : 1;
+        IRBlock *target = term->targets[t];
+        uint32_t begin = term->targetArgBegin(t);
+        std::vector<IRValue *> args;
+        for (uint32_t i = 0; i < target->num_args; ++i)
+            args.push_back(term->operand(begin + i));
+        block->insertBefore(module.newJump(target, args), term);
+        term->eraseFromParent();
+    }
+    remove_unreachable_blocks(func);
+    forward_single_edge_args(func);
+    remove_unused_block_args(module, func);
+}
+
+void SCCP::run() {
+    int num_blocks = 0, num_values = 0;
+    for (IRBlock *block : blocks(func)) {
+        block->id = num_blocks++;
+        for (uint32_t i = 0; i < block->num_args; ++i)
+            block->args[i]->id = num_values++;
+        for (IRInst *inst : insts(block))
+            inst->id = num_values++;
+    }
+    lattices.assign(num_values, Lattice());
+    executable.assign(num_blocks, false);
+
+    markExecutable(func->entry());
+    while (!block_worklist.empty() || !value_worklist.empty()) {
+        if (!value_worklist.empty()) {
+            // 值的格值下降了：重新计算可执行块中的使用者
+            IRValue *value = value_worklist.back();
+            value_worklist.pop_back();
+            for (IRUse *use = value->uses; use; use = use->next)
+                if (executable[use->user->parent->id])
+                    visit(use->user);
+            continue;
+        }
+        IRBlock *block = block_worklist.back();
+        block_worklist.pop_back();
+        for (IRInst *inst : insts(block))
+            visit(inst);
+    }
+    rewrite();
+}
+
+} // namespace
+
+SCCPStats propagate_constants(IRModule &module, IRFunction *func) {
+    SCCPStats stats;
+    if (func->isDeclaration())
+        return stats;
+    auto count = [func](int &num_blocks, int &num_insts) {
+        num_blocks = num_insts = 0;
+        for (IRBlock *block = func->first; block; block = block->next) {
+            ++num_blocks;
+            for (IRInst *inst = block->first; inst; inst = inst->next)
+                ++num_insts;
+        }
+    };
+    int blocks_before, insts_before, blocks_after, insts_after;
+    count(blocks_before, insts_before);
+    SCCP(module, func).run();
+    count(blocks_after, insts_after);
+    stats.insts_removed = insts_before - insts_after;
+    stats.blocks_removed = blocks_before - blocks_after;
+    return stats;
+}
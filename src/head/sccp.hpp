@@ -0,0 +1,14 @@
+#pragma once
+#include "ir.hpp"
+
+// 稀疏条件常量传播（Wegman、Zadeck）。在 mem2reg 之后的 SSA 上运行。
+// 每个值的格值为 未定 > 常量 > 不是常量，只沿可执行的边传播：
+// 基本块参数取各条可执行入边上实参的交，br 的条件是常量时只有一条出边
+// 可执行。结束后把常量值的使用换成立即数并删除其定义，条件为常量的 br
+// 改为 jump，删除由此不可达的基本块；只剩一条入边的块的参数直接换成
+// 实参，最后删除不再使用的基本块参数。
+struct SCCPStats {
+    int insts_removed = 0;  // 删除的指令数（含被删除基本块中的指令）
+    int blocks_removed = 0; // 删除的基本块数
+};
+SCCPStats propagate_constants(IRModule &module, IRFunction *func);
@@ -0,0 +1,98 @@
+#include "source_buffer.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SourceBuffer::~SourceBuffer() {
+    close();
+}
+
+bool SourceBuffer::open(const char *path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    bool ok;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        ok = map_file(fd, static_cast<size_t>(st.st_size)) || read_stream(fd);
+    else
+        ok = read_stream(fd); // 管道、空文件等走整体读入
+    ::close(fd);
+    return ok;
+}
+
+void SourceBuffer::close() {
+    if (!base)
+        return;
+    if (mapped)
+        munmap(base, capacity);
+    else
+        free(base);
+    base = nullptr;
+    length = capacity = 0;
+    mapped = false;
+}
+
+// 先保留一段比文件多出至少两个字节的匿名零页，再把文件以 MAP_FIXED
+// 覆盖到开头：文件末页的剩余部分由内核填零，若文件恰好页对齐，
+// 结尾的两个 '\0' 就落在后面的匿名页里。MAP_PRIVATE + PROT_WRITE
+// 是因为 flex 扫描时会临时改写 token 末尾的字符。
+bool SourceBuffer::map_file(int fd, size_t file_size) {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t total = (file_size + 2 + page - 1) / page * page;
+    void *region = mmap(nullptr, total, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED)
+        return false;
+    void *file = mmap(region, file_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_FIXED, fd, 0);
+    if (file == MAP_FAILED) {
+        munmap(region, total);
+        return false;
+    }
+    madvise(region, total, MADV_SEQUENTIAL);
+    base = static_cast<char *>(region);
+    length = file_size;
+    capacity = total;
+    mapped = true;
+    return true;
+}
+
+bool SourceBuffer::read_stream(int fd) {
+    size_t cap = 1 << 16, len = 0;
+    char *buf = static_cast<char *>(malloc(cap));
+    if (!buf)
+        return false;
+    for (;;) {
+        if (cap - len < 2 + 4096) {
+            cap *= 2;
+            char *grown = static_cast<char *>(realloc(buf, cap));
+            if (!grown) {
+                free(buf);
+                return false;
+            }
+            buf = grown;
+        }
+        ssize_t n = read(fd, buf + len, cap - len - 2);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            free(buf);
+            return false;
+        }
+        if (n == 0)
+            break;
+        len += static_cast<size_t>(n);
+    }
+    buf[len] = buf[len + 1] = '\0';
+    base = buf;
+    length = len;
+    capacity = cap;
+    mapped = false;
+    return true;
+}
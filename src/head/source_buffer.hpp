@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+
+// 源文件输入缓冲：普通文件直接 mmap 映射，就地交给 flex 扫描（零拷贝）；
+// 管道、字符设备等无法映射的输入退回到一次性整体读入内存。
+// 无论哪种方式，缓冲区末尾都保证有两个 '\0'，满足 yy_scan_buffer 的要求。
+class SourceBuffer {
+public:
+    SourceBuffer() = default;
+    SourceBuffer(const SourceBuffer &) = delete;
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+    ~SourceBuffer();
+
+    // 打开并载入输入文件，失败时返回 false
+    bool open(const char *path);
+    // 释放映射或内存
+    void close();
+
+    char *data() const {
+        return base;
+    }
+    // 源文件内容长度（不含末尾的两个 '\0'）
+    size_t size() const {
+        return length;
+    }
+    // 交给 yy_scan_buffer 的长度（含末尾的两个 '\0'）
+    size_t scan_size() const {
+        return length + 2;
+    }
+    bool is_mapped() const {
+        return mapped;
+    }
+
+private:
+    bool map_file(int fd, size_t file_size);
+    bool read_stream(int fd);
+
+    char *base = nullptr;
+    size_t length = 0;
+    size_t capacity = 0; // mmap 时为映射区总长度，读入时为 malloc 的长度
+    bool mapped = false;
+};
@@ -0,0 +1,190 @@
+#pragma once
+#include "ast.hpp"
+#include "exp.hpp"
+#include "stmt.hpp"
+#include <algorithm>
+#include <vector>
+
+// 按 node_kind 依次对节点的每个非空子节点调用 f
+template <class F> void for_each_child(BaseAST *node, F &&f) {
+    auto each = [&](const ASTList &list) {
+        for (const auto &child : list)
+            f(child.get());
+    };
+    auto one = [&](const std::unique_ptr<BaseAST> &child) {
+        if (child)
+            f(child.get());
+    };
+    switch (node->node_kind) {
+    case ASTKind::CompUnit:
+        one(cast<CompUnitAST>(node)->func_defs);
+        break;
+    case ASTKind::FuncDefs:
+        each(cast<FuncDefsAST>(node)->func_defs);
+        break;
+    case ASTKind::FuncFParam:
+        one(cast<FuncFParamAST>(node)->btype);
+        break;
+    case ASTKind::FuncFParams:
+        each(cast<FuncFParamsAST>(node)->params);
+        break;
+    case ASTKind::FuncRParams:
+        each(cast<FuncRParamsAST>(node)->params);
+        break;
+    case ASTKind::FuncDef: {
+        FuncDefAST *def = cast<FuncDefAST>(node);
+        one(def->func_type);
+        one(def->func_params);
+        one(def->block);
+        break;
+    }
+    case ASTKind::Block:
+        each(cast<BlockAST>(node)->block_items);
+        break;
+    case ASTKind::BlockItem:
+        one(cast<BlockItemAST>(node)->item);
+        break;
+    case ASTKind::Decl:
+        one(cast<DeclAST>(node)->decl);
+        break;
+    case ASTKind::ConstDecl:
+        one(cast<ConstDeclAST>(node)->btype);
+        each(cast<ConstDeclAST>(node)->const_defs);
+        break;
+    case ASTKind::VarDecl:
+        one(cast<VarDeclAST>(node)->btype);
+        each(cast<VarDeclAST>(node)->var_defs);
+        break;
+    case ASTKind::ConstDef:
+        one(cast<ConstDefAST>(node)->const_init_val);
+        break;
+    case ASTKind::VarDef:
+        one(cast<VarDefAST>(node)->init_val);
+        break;
+    case ASTKind::BinaryExp:
+        one(cast<BinaryExpAST>(node)->lhs);
+        one(cast<BinaryExpAST>(node)->rhs);
+        break;
+    case ASTKind::UnaryOpExp:
+        one(cast<UnaryOpExpAST>(node)->operand);
+        break;
+    case ASTKind::CallExp:
+        one(cast<CallExpAST>(node)->func_rparams);
+        break;
+    case ASTKind::Stmt: {
+        StmtAST *stmt = cast<StmtAST>(node);
+        one(stmt->lval);
+        one(stmt->exp);
+        one(stmt->then_stmt);
+        one(stmt->else_stmt);
+        one(stmt->block);
+        break;
+    }
+    case ASTKind::FuncType:
+    case ASTKind::BType:
+    case ASTKind::Number:
+    case ASTKind::LVal:
+        break;
+    }
+}
+
+// 语法树遍历框架（CRTP）。遍历用显式工作栈代替递归，语法树再深
+// （上百万层的括号、if 嵌套或 a+b+...+z 长链）也只占用固定大小的调用栈。
+//
+// walk(root) 对每个节点先调用派生类的 enterXxx(node)：
+//   - 返回 true：按顺序遍历所有子节点，之后调用 leaveXxx(node)；
+//   - 返回 false：跳过子树，也不调用 leaveXxx。此时 enterXxx 可以用
+//     schedule() 自行安排要访问的子节点和后续步骤，步骤到达时调用
+//     派生类的 resume(node, step)，用来在子节点之间插入处理
+//     （例如 if 语句在 then 和 else 分支之间输出跳转）。
+// 派生类只需定义关心的 enterXxx/leaveXxx，其余节点默认进入子节点、离开时
+// 不做任何事。enterXxx/leaveXxx 中可以对别的子树再次调用 walk()，
+// 它在处理完该子树后返回。
+//
+//   class MyPass : public ASTVisitor<MyPass> {
+//   public:
+//       void leaveNumber(NumberAST *node) { ... }
+//   };
+template <class Derived> class ASTVisitor {
+public:
+    void walk(BaseAST *root) {
+        size_t base = work.size();
+        work.push_back({root, ENTER});
+        while (work.size() > base) {
+            WorkItem item = work.back();
+            work.pop_back();
+            if (item.step == ENTER) {
+                if (!enter(item.node))
+                    continue;
+                work.push_back({item.node, LEAVE});
+                // 子节点逆序入栈，出栈时就是源码顺序
+                size_t first = work.size();
+                for_each_child(item.node, [this](BaseAST *child) {
+                    work.push_back({child, ENTER});
+                });
+                std::reverse(work.begin() + first, work.end());
+            } else if (item.step == LEAVE) {
+                leave(item.node);
+            } else {
+                derived().resume(item.node, item.step);
+            }
+        }
+    }
+
+#define AST_DEFAULT_HOOKS(NAME)                                                \
+    bool enter##NAME(NAME##AST *) {                                            \
+        return true;                                                           \
+    }                                                                          \
+    void leave##NAME(NAME##AST *) {                                            \
+    }
+    AST_NODE_KINDS(AST_DEFAULT_HOOKS)
+#undef AST_DEFAULT_HOOKS
+
+    void resume(BaseAST *, int) {
+        assert(false && "resume() not implemented");
+    }
+
+protected:
+    // 派生类自定义的步骤编号必须大于 0
+    static constexpr int ENTER = -1;
+    static constexpr int LEAVE = 0;
+
+    // 安排一个后续工作：step 为 ENTER 时遍历 node 的子树，
+    // 否则稍后调用 resume(node, step)。后安排的先执行（栈）。
+    void schedule(BaseAST *node, int step = ENTER) {
+        work.push_back({node, step});
+    }
+
+    Derived &derived() {
+        return *static_cast<Derived *>(this);
+    }
+
+private:
+    struct WorkItem {
+        BaseAST *node;
+        int step;
+    };
+
+    bool enter(BaseAST *node) {
+        switch (node->node_kind) {
+#define AST_ENTER_CASE(NAME)                                                   \
+    case ASTKind::NAME:                                                        \
+        return derived().enter##NAME(static_cast<NAME##AST *>(node));
+            AST_NODE_KINDS(AST_ENTER_CASE)
+#undef AST_ENTER_CASE
+        }
+        return false;
+    }
+    void leave(BaseAST *node) {
+        switch (node->node_kind) {
+#define AST_LEAVE_CASE(NAME)                                                   \
+    case ASTKind::NAME:                                                        \
+        derived().leave##NAME(static_cast<NAME##AST *>(node));                 \
+        break;
+            AST_NODE_KINDS(AST_LEAVE_CASE)
+#undef AST_LEAVE_CASE
+        }
+    }
+
+    std::vector<WorkItem> work;
+};
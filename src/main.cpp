@@ -1,16 +1,30 @@
 #include "head/ast.hpp"
-#include "head/exp.hpp"
+#include "head/const_eval.hpp"
+#include "head/dce.hpp"
+#include "head/fast_lexer.hpp"
+#include "head/gvn.hpp"
+#include "head/ir_binary.hpp"
+#include "head/ir_builder.hpp"
+#include "head/ir_printer.hpp"
 #include "head/koopa.h"
 #include "head/koopa_to_riscv.hpp"
-#include "head/stmt.hpp"
+#include "head/mem2reg.hpp"
+#include "head/sccp.hpp"
+#include "head/name_binding.hpp"
+#include "head/output_buffer.hpp"
+#include "head/source_buffer.hpp"
+#include "sysy.tab.hpp"
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
-#include <fstream>
 #include <iostream>
 #include <memory>
-#include <sstream>
 #include <string>
+#include <sys/resource.h>
+#include <unordered_set>
 using namespace std;
 /*
 cmake --build build --parallel 4   # 增量构建
@@ -18,15 +32,15 @@ cmake --build build --parallel 4   # 增量构建
 
 */
 
-/*
-    使用全局变量控制输出流，如果出线了return，则不输出作用域内的后续语句
-    每个%开头的标识符都是一个作用域块
-*/
-bool has_returned = 0; // 全局控制输出流标记
-int TemValId = 0;      // 全局变量编号（临时，局部，全局）
-int block_counter = 0;
+StringInterner interner; // 标识符驻留表，必须先于 symTab 使用
+Arena ast_arena;         // 语法树内存池
 SymbolTable symTab;
 
+bool use_fast_lexer = false; // -fast-lex：使用手写词法分析器代替 flex
+FuncDefSink func_def_sink = nullptr; // -stream：逐函数编译
+bool optimize_ir = true;             // -O0：不运行 IR 上的优化遍
+bool print_stats = false;            // -stats：输出各优化遍的统计
+
 int lib_size = 8;
 const string lib_ident[] = {"getint", "getch",    "getarray",  "putint",
                             "putch",  "putarray", "starttime", "stoptime"};
@@ -34,102 +48,565 @@ const string lib_type[] = {"i32",  "i32",  "i32",  "void",
                            "void", "void", "void", "void"};
 const std::vector<std::string> lib_param[] = {
     {}, {}, {"*i32"}, {"i32"}, {"i32"}, {"i32", "*i32"}, {}, {}};
-void add_declare_library_functions() {
-    for (int i = 0; i < 8; i++) {
-        std::cout << "decl " << "@";
-        std::cout << lib_ident[i] << "(";
-        for (int j = 0; j < lib_param[i].size(); j++) {
-            std::cout << lib_param[i][j];
-            if (j != lib_param[i].size() - 1)
-                std::cout << ", ";
-        }
-        std::cout << ")";
-        if (lib_type[i] == "i32")
-            std::cout << ": " << lib_type[i];
-        else if (lib_type[i] == "void")
-            ;
-        std::cout << std::endl;
-        symTab.addFunction(lib_ident[i], lib_type[i], lib_param[i]);
+// 把库函数登记到符号表，名字绑定之前调用
+void add_library_functions() {
+    for (int i = 0; i < lib_size; i++)
+        symTab.addFunction(interner.intern(lib_ident[i]), lib_type[i],
+                           lib_param[i]);
+}
+// 在 IR 模块中声明库函数
+void declare_library_functions(IRModule &module) {
+    for (int i = 0; i < lib_size; i++) {
+        std::vector<const IRType *> params;
+        for (const std::string &param : lib_param[i])
+            params.push_back(ir_type(module, param));
+        module.addFunction(
+            interner.str(interner.intern(lib_ident[i])),
+            module.functionType(params, ir_type(module, lib_type[i])));
     }
 }
-extern FILE *yyin;
+extern int yylex();
 extern int yyparse(unique_ptr<BaseAST> &ast);
-void getIR(std::unique_ptr<BaseAST> &ast, const char *output_file) {
-    ofstream out_file(output_file);
-    std::streambuf *coutbuf = std::cout.rdbuf();
-    std::cout.rdbuf(out_file.rdbuf());
-    add_declare_library_functions();
-    ast->Dump();
-    std::cout.rdbuf(coutbuf);
-}
-void getRiscv(std::unique_ptr<BaseAST> &ast, const char *output_file) {
-    // 第一步：生成 Koopa IR 到字符串
-    std::ostringstream oss;
-    std::streambuf *coutbuf = std::cout.rdbuf();
-    std::cout.rdbuf(oss.rdbuf());
-    ast->Dump();
-    std::cout.rdbuf(coutbuf);
-    std::string koopa_ir_str = oss.str();
-
-    // 第二步：转换为内存形式的 Koopa IR
-    koopa_program_t program;
-    koopa_error_code_t ret =
-        koopa_parse_from_string(koopa_ir_str.c_str(), &program);
-    if (ret != KOOPA_EC_SUCCESS) {
-        std::cerr << "Error: Failed to parse Koopa IR" << std::endl;
+extern bool lex_from_buffer(char *base, size_t len);
+extern void lex_from_file(FILE *file);
+extern void lex_release_buffer();
+extern int lex_next_flex(YYSTYPE &lval);
+// 前端分析：名字绑定、常量求值，结果缓存在语法树节点上。
+// 名字绑定出错时返回 false（错误已输出），语法树不能再往下处理
+bool analyze(std::unique_ptr<BaseAST> &ast) {
+    add_library_functions();
+    if (!bind_names(ast.get()))
+        return false;
+    evaluate_constants(ast.get());
+    return true;
+}
+// 各优化遍在整个程序上的统计
+struct OptStats {
+    long promoted = 0;    // mem2reg 提升的变量
+    long sccp_insts = 0;  // SCCP 删除的指令
+    long sccp_blocks = 0; // SCCP 删除的基本块
+    long gvn_insts = 0;   // GVN 删除的冗余指令
+    long dce_insts = 0;   // DCE 删除的指令和基本块参数
+};
+static OptStats opt_stats;
+// IR 上的优化遍，逐函数进行
+void optimize_function(IRModule &module, IRFunction *func) {
+    if (!optimize_ir || func->isDeclaration())
+        return;
+    opt_stats.promoted += promote_memory_to_registers(module, func);
+    SCCPStats sccp = propagate_constants(module, func);
+    opt_stats.sccp_insts += sccp.insts_removed;
+    opt_stats.sccp_blocks += sccp.blocks_removed;
+    opt_stats.gvn_insts += number_values(func);
+    opt_stats.dce_insts += eliminate_dead_code(module, func);
+    // 调用者在它之后编译，据此删除结果不用的调用
+    func->pure = is_pure_function(func);
+}
+void report_stats() {
+    if (!print_stats)
+        return;
+    std::cerr << "mem2reg: " << opt_stats.promoted << " 个变量被提升\n"
+              << "sccp: 删除 " << opt_stats.sccp_insts << " 条指令、"
+              << opt_stats.sccp_blocks << " 个基本块\n"
+              << "gvn: 删除 " << opt_stats.gvn_insts << " 条冗余指令\n"
+              << "dce: 删除 " << opt_stats.dce_insts << " 条死代码\n";
+}
+// 语法树 -> IR
+void lower(std::unique_ptr<BaseAST> &ast, IRModule &module) {
+    declare_library_functions(module);
+    IREmitter emitter(module);
+    IRBuilder(emitter).build(ast.get());
+    for (IRFunction *func : module.functions())
+        optimize_function(module, func);
+}
+// 打开输出文件，交给 emit 写入 module
+template <class Emit>
+void write_output(IRModule &module, const char *output_file, Emit emit) {
+    OutputBuffer out;
+    if (!out.open(output_file)) {
+        std::cerr << "Error: Cannot open output file " << output_file
+                  << std::endl;
         return;
     }
+    emit(module, out);
+    if (!out.close())
+        std::cerr << "Error: Failed to write " << output_file << std::endl;
+}
+void getIR(IRModule &module, const char *output_file) {
+    write_output(module, output_file, print_koopa);
+}
+void getRiscv(IRModule &module, const char *output_file) {
+    write_output(module, output_file, generate_riscv);
+}
+void getKir(IRModule &module, const char *output_file) {
+    write_output(module, output_file, write_kir);
+}
 
-    koopa_raw_program_builder_t builder = koopa_new_raw_program_builder();
-    koopa_raw_program_t raw = koopa_build_raw_program(builder, program);
-    koopa_delete_program(program);
+// 逐函数编译（-stream）：每个函数归约后立即完成分析、生成 IR 并输出，
+// 随后释放它的语法树和 IR。内存占用只取决于最大的函数而不是整个文件。
+// SysY 要求函数先定义后调用，因此被调函数此时都已登记在 symTab 中
+struct Stream {
+    OutputBuffer out;
+    bool riscv = false;
+    int next_label = 0; // 基本块标号在函数之间连续，输出与整体编译相同
+    // 已编译的纯函数，后面的模块中它们只是声明，纯不纯由这里记录
+    std::unordered_set<std::string> pure_functions;
+    // 有函数名字绑定出错：之后的函数仍做名字绑定以报告错误，但不再输出
+    bool failed = false;
+};
+static Stream stream;
 
-    // 第三步：生成 RISC-V 汇编并输出到文件
-    std::ofstream out_file(output_file);
-    if (!out_file.is_open()) {
+static void compile_function(std::unique_ptr<BaseAST> ast) {
+    FuncDefAST *def = cast<FuncDefAST>(ast.get());
+    if (!bind_names(def))
+        stream.failed = true;
+    if (!stream.failed) {
+        evaluate_constants(def);
+        // 每个函数一个模块，调用到的其他函数在其中只是声明
+        IRModule module;
+        declare_library_functions(module);
+        IREmitter emitter(module);
+        IRBuilder builder(emitter, stream.next_label);
+        builder.build(def);
+        stream.next_label = builder.nextLabel();
+
+        for (IRFunction *callee : module.functions())
+            if (callee->isDeclaration())
+                callee->pure = stream.pure_functions.count(callee->name) > 0;
+        IRFunction *func = module.findFunction(interner.str(def->ident));
+        optimize_function(module, func);
+        if (func->pure)
+            stream.pure_functions.insert(func->name);
+        if (stream.riscv)
+            generate_riscv_function(func, stream.out);
+        else
+            print_koopa_function(func, stream.out);
+    }
+    // 分析器栈上没有其他语法树节点（FuncDefs 此时为空），内存池可以整体归还
+    ast.release();
+    ast_arena.release();
+}
+
+// 边解析边输出。返回值同 yyparse
+static int compile_stream(bool riscv, const char *output_file) {
+    stream.riscv = riscv;
+    if (!stream.out.open(output_file)) {
         std::cerr << "Error: Cannot open output file " << output_file
                   << std::endl;
-        koopa_delete_raw_program_builder(builder);
-        return;
+        return 1;
+    }
+    {
+        // 开头部分：.text 或库函数的声明
+        IRModule module;
+        declare_library_functions(module);
+        if (riscv)
+            generate_riscv(module, stream.out);
+        else
+            print_koopa(module, stream.out);
     }
-    generate_riscv(raw, out_file);
-    out_file.close();
+    add_library_functions();
+    func_def_sink = compile_function;
+    std::unique_ptr<BaseAST> ast;
+    int parse_ret = yyparse(ast);
+    func_def_sink = nullptr;
+    ast.release();
+    ast_arena.release();
+    if (!stream.out.close())
+        std::cerr << "Error: Failed to write " << output_file << std::endl;
+    return parse_ret;
+}
 
-    // 第四步：清理内存
-    koopa_delete_raw_program_builder(builder);
+// 扫描完整个输入，返回 token 数
+static long count_tokens() {
+    long tokens = 0;
+    for (int tok = yylex(); tok != 0; tok = yylex())
+        tokens++;
+    return tokens;
 }
 
-int main(int argc, const char *argv[]) {
-    // 检查命令行参数
-    assert(argc == 5);
+// 词法分析吞吐量对比：compiler -lex-bench <input>
+// 分别测 stdio (yyin)、mmap 就地扫描、mmap + 手写 SIMD 词法分析器三种方式，
+// 每种跑若干轮取最快一轮
+static int lex_benchmark(const char *input_file) {
+    const int rounds = 3;
+    using clock = std::chrono::steady_clock;
+    double best_stdio = 1e30, best_mmap = 1e30, best_fast = 1e30;
+    long tokens = 0;
+    for (int r = 0; r < rounds; r++) {
+        auto start = clock::now();
+        FILE *file = fopen(input_file, "r");
+        if (!file) {
+            std::cerr << "Error: Cannot open input file " << input_file
+                      << std::endl;
+            return 1;
+        }
+        use_fast_lexer = false;
+        lex_from_file(file);
+        tokens = count_tokens();
+        fclose(file);
+        best_stdio = std::min(
+            best_stdio,
+            std::chrono::duration<double>(clock::now() - start).count());
 
-    const char *input_file = argv[2];
-    const char *output_file = argv[4];
+        for (bool fast : {false, true}) {
+            start = clock::now();
+            SourceBuffer source;
+            if (!source.open(input_file) ||
+                !lex_from_buffer(source.data(), source.scan_size())) {
+                std::cerr << "Error: Cannot map input file " << input_file
+                          << std::endl;
+                return 1;
+            }
+            use_fast_lexer = fast;
+            count_tokens();
+            lex_release_buffer();
+            double &best = fast ? best_fast : best_mmap;
+            best = std::min(best, std::chrono::duration<double>(
+                                      clock::now() - start)
+                                      .count());
+        }
+    }
+    use_fast_lexer = false;
+    std::cerr << "tokens: " << tokens << "\n";
+    std::cerr << "stdio: " << best_stdio * 1e3 << " ms, "
+              << tokens / best_stdio << " tokens/s\n";
+    std::cerr << "mmap:  " << best_mmap * 1e3 << " ms, "
+              << tokens / best_mmap << " tokens/s\n";
+    std::cerr << "fast:  " << best_fast * 1e3 << " ms, "
+              << tokens / best_fast << " tokens/s\n";
+    return 0;
+}
 
-    // 打开输入文件
-    yyin = fopen(input_file, "r");
-    if (!yyin) {
+// 差分检查：compiler -lex-diff <input>
+// 同时用 flex 和手写词法分析器扫描同一文件，逐个比较 token 及其值。
+// flex 扫描时会临时改写缓冲区，所以手写词法分析器在一份拷贝上运行。
+static int lex_diff(const char *input_file) {
+    SourceBuffer source;
+    if (!source.open(input_file) ||
+        !lex_from_buffer(source.data(), source.scan_size())) {
         std::cerr << "Error: Cannot open input file " << input_file
                   << std::endl;
         return 1;
     }
+    std::string copy(source.data(), source.size());
+    FastLexer fast;
+    fast.reset(copy.data(), copy.data() + copy.size());
+    for (long index = 0;; index++) {
+        YYSTYPE expect, got;
+        int tok_flex = lex_next_flex(expect);
+        int tok_fast = fast.next(got);
+        bool same = tok_flex == tok_fast;
+        if (same && tok_flex == IDENT)
+            same = expect.sym_val == got.sym_val;
+        if (same && tok_flex == INT_CONST)
+            same = expect.int_val == got.int_val;
+        if (!same) {
+            std::cerr << input_file << ": token " << index
+                      << " differs: flex " << tok_flex << ", fast "
+                      << tok_fast << std::endl;
+            lex_release_buffer();
+            return 1;
+        }
+        if (tok_flex == 0)
+            break;
+    }
+    lex_release_buffer();
+    return 0;
+}
 
-    // 解析 SysY 源文件生成 AST
+// 语法分析开销：compiler -parse-bench <input>
+// 输出建树耗时、释放语法树的耗时和进程峰值 RSS
+static int parse_benchmark(const char *input_file) {
+    using clock = std::chrono::steady_clock;
+    SourceBuffer source;
+    if (!source.open(input_file) ||
+        !lex_from_buffer(source.data(), source.scan_size())) {
+        std::cerr << "Error: Cannot open input file " << input_file
+                  << std::endl;
+        return 1;
+    }
+    use_fast_lexer = true; // 只关心建树本身，用更快的词法分析器
+    auto start = clock::now();
     std::unique_ptr<BaseAST> ast;
     int parse_ret = yyparse(ast);
-    fclose(yyin);
-    if (parse_ret != 0) {
-        std::cerr << "Error: Parsing failed" << std::endl;
+    auto parsed = clock::now();
+    lex_release_buffer();
+    size_t arena_bytes = ast_arena.bytes_allocated();
+    ast.release(); // 节点都在 ast_arena 中，整体释放，不逐个析构
+    ast_arena.release();
+    auto freed = clock::now();
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cerr << "parse: "
+              << std::chrono::duration<double>(parsed - start).count() * 1e3
+              << " ms\n";
+    std::cerr << "free:  "
+              << std::chrono::duration<double>(freed - parsed).count() * 1e3
+              << " ms\n";
+    std::cerr << "AST arena: " << arena_bytes / 1024 << " KiB\n";
+    std::cerr << "peak RSS: " << usage.ru_maxrss << " KiB\n";
+    return parse_ret;
+}
+
+// 生成嵌套深度/长度为 n 的测试程序
+static std::string deep_source(const std::string &shape, int n) {
+    std::string src = "int main() { int x = 1; ";
+    auto repeat = [&src](const char *text, int count) {
+        for (int i = 0; i < count; i++)
+            src += text;
+    };
+    if (shape == "add-chain") { // return 1 + 1 + ... + 1;
+        src += "return 1";
+        repeat(" + 1", n);
+        src += "; }";
+    } else if (shape == "parens") { // return ((...(1)...));
+        src += "return ";
+        repeat("(", n);
+        src += "x";
+        repeat(")", n);
+        src += "; }";
+    } else if (shape == "unary") { // return ---...-x;
+        src += "return ";
+        repeat("-", n);
+        src += "x; }";
+    } else if (shape == "if-nest") { // if (x) if (x) ... x = 2;
+        repeat("if (x) ", n);
+        src += "x = 2; return x; }";
+    } else { // while (x) { while (x) { ... break; } }
+        repeat("while (x) { ", n);
+        src += "x = 0; break; ";
+        repeat("}", n);
+        src += " return x; }";
+    }
+    src.append(2, '\0'); // yy_scan_buffer 要求的结尾
+    return src;
+}
+
+// 深层嵌套回归测试：compiler -depth-bench [n]
+// 对每种形状分别用 n/4、n/2、n 的规模跑完整前端（建树、分析、生成 Koopa），
+// 耗时应随规模线性增长，且不会因递归过深而栈溢出
+static int depth_benchmark(int n) {
+    using clock = std::chrono::steady_clock;
+    const char *shapes[] = {"add-chain", "parens", "unary", "if-nest",
+                            "while-nest"};
+    use_fast_lexer = true;
+    for (const char *shape : shapes) {
+        double per_node[3];
+        for (int k = 0; k < 3; k++) {
+            int size = n >> (2 - k);
+            std::string src = deep_source(shape, size);
+            symTab = SymbolTable();
+            auto start = clock::now();
+            lex_from_buffer(&src[0], src.size());
+            std::unique_ptr<BaseAST> ast;
+            if (yyparse(ast) != 0) {
+                std::cerr << shape << " " << size << ": parse failed\n";
+                return 1;
+            }
+            lex_release_buffer();
+            auto parsed = clock::now();
+            if (!analyze(ast))
+                return 1;
+            IRModule module;
+            lower(ast, module);
+            OutputBuffer ir;
+            print_koopa(module, ir);
+            auto built = clock::now();
+            ast.release();
+            ast_arena.release();
+
+            double parse_ms =
+                std::chrono::duration<double>(parsed - start).count() * 1e3;
+            double build_ms =
+                std::chrono::duration<double>(built - parsed).count() * 1e3;
+            per_node[k] = (parse_ms + build_ms) * 1e6 / size;
+            std::cerr << shape << " n=" << size << ": parse " << parse_ms
+                      << " ms, analyze+IR " << build_ms << " ms, "
+                      << per_node[k] << " ns/level\n";
+        }
+        // 线性时每层耗时基本不变
+        std::cerr << shape << ": ns/level ratio n vs n/4 = "
+                  << per_node[2] / per_node[0] << "\n";
+    }
+    return 0;
+}
+
+// KIR 载入耗时：compiler -kir-bench <file.kir>
+// 与把同一程序的 Koopa 文本交给 libkoopa 解析并建立 raw program 对比，
+// 各取多轮中最快的一次
+static int kir_benchmark(const char *input_file) {
+    using clock = std::chrono::steady_clock;
+    const int rounds = 5;
+    double kir_ms = 1e30;
+    std::string koopa_text;
+    for (int r = 0; r < rounds; r++) {
+        auto start = clock::now();
+        SourceBuffer source;
+        IRModule module;
+        if (!source.open(input_file) || !read_kir(source, module)) {
+            std::cerr << "Error: Invalid KIR file " << input_file << "\n";
+            return 1;
+        }
+        auto end = clock::now();
+        kir_ms = std::min(
+            kir_ms, std::chrono::duration<double>(end - start).count() * 1e3);
+        if (r == 0) {
+            std::cerr << "kir: " << source.size() << " bytes\n";
+            OutputBuffer text;
+            print_koopa(module, text);
+            koopa_text = text.view();
+        }
+    }
+    std::cerr << "kir load (mmap + read_kir): " << kir_ms << " ms\n";
+
+    double koopa_ms = 1e30;
+    for (int r = 0; r < rounds; r++) {
+        auto start = clock::now();
+        koopa_program_t program;
+        if (koopa_parse_from_string(koopa_text.c_str(), &program) !=
+            KOOPA_EC_SUCCESS) {
+            std::cerr << "Error: libkoopa rejected the program\n";
+            return 1;
+        }
+        koopa_raw_program_builder_t builder = koopa_new_raw_program_builder();
+        koopa_build_raw_program(builder, program);
+        auto end = clock::now();
+        koopa_delete_raw_program_builder(builder);
+        koopa_delete_program(program);
+        koopa_ms = std::min(
+            koopa_ms, std::chrono::duration<double>(end - start).count() * 1e3);
+    }
+    std::cerr << "koopa: " << koopa_text.size() << " bytes\n";
+    std::cerr << "koopa_parse_from_string + build_raw_program: " << koopa_ms
+              << " ms\n";
+    return 0;
+}
+
+int main(int argc, const char *argv[]) {
+    if (argc == 3 && strcmp(argv[1], "-lex-bench") == 0)
+        return lex_benchmark(argv[2]);
+    if (argc == 3 && strcmp(argv[1], "-lex-diff") == 0)
+        return lex_diff(argv[2]);
+    if (argc == 3 && strcmp(argv[1], "-parse-bench") == 0)
+        return parse_benchmark(argv[2]);
+    if (argc == 3 && strcmp(argv[1], "-kir-bench") == 0)
+        return kir_benchmark(argv[2]);
+    if ((argc == 2 || argc == 3) && strcmp(argv[1], "-depth-bench") == 0)
+        return depth_benchmark(argc == 3 ? atoi(argv[2]) : 1000000);
+
+    // 检查命令行参数：
+    //   compiler -koopa|-riscv|-emit=kir <input> -o <output> [选项...]
+    // 选项：-fast-lex 使用手写词法分析器；-from-kir 输入是 KIR 文件；
+    //       -stream 逐函数编译（仅 -koopa/-riscv）；-O0 不做 IR 优化；
+    //       -stats 在 stderr 上输出优化遍的统计
+    assert(argc >= 5);
+
+    const char *input_file = argv[2];
+    const char *output_file = argv[4];
+    bool from_kir = false;
+    bool streaming = false;
+    for (int i = 5; i < argc; i++) {
+        if (strcmp(argv[i], "-fast-lex") == 0)
+            use_fast_lexer = true;
+        else if (strcmp(argv[i], "-from-kir") == 0)
+            from_kir = true;
+        else if (strcmp(argv[i], "-stream") == 0)
+            streaming = true;
+        else if (strcmp(argv[i], "-O0") == 0)
+            optimize_ir = false;
+        else if (strcmp(argv[i], "-stats") == 0)
+            print_stats = true;
+    }
+    bool to_riscv = strcmp(argv[1], "-riscv") == 0;
+    if (streaming && !to_riscv && strcmp(argv[1], "-koopa") != 0) {
+        std::cerr << "Error: -stream 只支持 -koopa 和 -riscv" << std::endl;
         return 1;
     }
 
+    if (streaming && !use_fast_lexer) {
+        // flex 通过 FILE* 分块读入，源文件也不必整个留在内存中
+        FILE *file = fopen(input_file, "r");
+        if (!file) {
+            std::cerr << "Error: Cannot open input file " << input_file
+                      << std::endl;
+            return 1;
+        }
+        lex_from_file(file);
+        int parse_ret = compile_stream(to_riscv, output_file);
+        fclose(file);
+        if (parse_ret != 0) {
+            std::cerr << "Error: Parsing failed" << std::endl;
+            return 1;
+        }
+        if (stream.failed) // 错误已由名字绑定输出
+            return 1;
+        report_stats();
+        return 0;
+    }
+
+    // 载入输入文件：普通文件 mmap 后就地扫描，管道等退回整体读入。
+    // KIR 输入中的名字直接指向映射区，因此 source 要比 module 活得久
+    SourceBuffer source;
+    IRModule module;
+    if (from_kir) {
+        if (!source.open(input_file)) {
+            std::cerr << "Error: Cannot open input file " << input_file
+                      << std::endl;
+            return 1;
+        }
+        if (!read_kir(source, module)) {
+            std::cerr << "Error: Invalid KIR file " << input_file
+                      << std::endl;
+            return 1;
+        }
+    } else {
+        if (!source.open(input_file) ||
+            !lex_from_buffer(source.data(), source.scan_size())) {
+            std::cerr << "Error: Cannot open input file " << input_file
+                      << std::endl;
+            return 1;
+        }
+
+        if (streaming) { // 手写词法分析器需要整个输入缓冲区
+            int parse_ret = compile_stream(to_riscv, output_file);
+            lex_release_buffer();
+            if (parse_ret != 0) {
+                std::cerr << "Error: Parsing failed" << std::endl;
+                return 1;
+            }
+            if (stream.failed) // 错误已由名字绑定输出
+                return 1;
+            report_stats();
+            return 0;
+        }
+
+        // 解析 SysY 源文件生成 AST
+        std::unique_ptr<BaseAST> ast;
+        int parse_ret = yyparse(ast);
+        lex_release_buffer();
+        source.close();
+        if (parse_ret != 0) {
+            std::cerr << "Error: Parsing failed" << std::endl;
+            return 1;
+        }
+
+        if (!analyze(ast))
+            return 1;
+        lower(ast, module);
+        // 之后只用到 IR，语法树整体归还给内存池，不逐个析构节点
+        ast.release();
+        ast_arena.release();
+    }
+
     if (strcmp(argv[1], "-koopa") == 0) {
-        getIR(ast, output_file);
-    } else if (strcmp(argv[1], "-riscv") == 0) {
-        getRiscv(ast, output_file);
+        getIR(module, output_file);
+    } else if (to_riscv) {
+        getRiscv(module, output_file);
+    } else if (strcmp(argv[1], "-emit=kir") == 0) {
+        getKir(module, output_file);
     } else {
         std::cerr << "Error: 不正确的指令" << std::endl;
     }
-
+    report_stats();
     return 0;
 }
@@ -25,33 +25,38 @@ bool flag = 0;  // 默认关闭调试输出，可在外部设置为 true 开启
 
 using namespace std;
 
-#define IS_EXP 0    // PrimaryExp 是表达式
-#define IS_LVAL 1   // PrimaryExp 是左值
-#define IS_NUMBER 2 // PrimaryExp 是数字
 #define IS_DECL true // BlockItem 是声明
 #define IS_STMT false // BlockItem 是语句
+
+// 语法分析栈：YYSTYPE 是平凡类型，Bison 会在栈满时用 malloc 把它加倍扩容。
+// 默认上限只有 10000 层，深层嵌套的括号、一元运算和 if/while 会报
+// "memory exhausted"，这里把上限放宽到只受内存限制
+#define YYINITDEPTH 1024
+#define YYMAXDEPTH 200000000
 %}
 
 %parse-param {std::unique_ptr<BaseAST>& ast}
 
 %union {
-  std::string *str_val;
+  SymId sym_val;
   int int_val;
   BaseAST *ast_val;
-  std::vector<std::unique_ptr<BaseAST>> *vec_ast_val;
+  ASTList *vec_ast_val;
+  UnaryOp unary_op_val;
 }
 
 %token INT VOID RETURN CONST IF ELSE WHILE BREAK CONTINUE
 %token AND OR
 %token EQ NE LT GT LE GE
-%token <str_val> IDENT
+%token <sym_val> IDENT
 %token <int_val> INT_CONST
 
 %type <ast_val> CompUnit FuncDefs FuncDef FuncType Block Decl ConstDecl VarDecl BType
-%type <ast_val> ConstDef ConstInitVal VarDef InitVal Exp PrimaryExp UnaryExp UnaryOp
+%type <ast_val> ConstDef ConstInitVal VarDef InitVal Exp PrimaryExp UnaryExp
 %type <ast_val> Number LVal ConstExp BlockItem AddExp MulExp RelExp EqExp LAndExp LOrExp
 %type <ast_val> Stmt OpenStmt ClosedStmt FuncFParam
 %type <vec_ast_val> BlockItemList ConstDefList VarDefList  FuncFParams FuncRParams
+%type <unary_op_val> UnaryOp
 %left OR
 %left AND
 %left EQ NE
@@ -75,11 +80,17 @@ CompUnit
 FuncDefs
   : /* empty */ {
     if (flag) cerr << "解析 FuncDefs: 空函数列表" << endl;
-    $$ = new FuncDefsAST(make_unique<vector<unique_ptr<BaseAST>>>());
+    $$ = func_def_sink ? nullptr : new FuncDefsAST(ASTList());
   }
   | FuncDefs FuncDef {
-    if (flag) cerr << "解析 FuncDefs: 添加函数定义，总数 " << dynamic_cast<FuncDefsAST*>($1)->func_defs->size() + 1 << endl;
-    dynamic_cast<FuncDefsAST*>($1)->func_defs->push_back(unique_ptr<BaseAST>($2));
+    if (func_def_sink) {
+      // 逐函数编译：立即交出，sink 处理完后会释放它占用的内存
+      if (flag) cerr << "解析 FuncDefs: 交出函数定义" << endl;
+      func_def_sink(unique_ptr<BaseAST>($2));
+    } else {
+      if (flag) cerr << "解析 FuncDefs: 添加函数定义，总数 " << cast<FuncDefsAST>($1)->func_defs.size() + 1 << endl;
+      cast<FuncDefsAST>($1)->func_defs.push_back(unique_ptr<BaseAST>($2));
+    }
     $$ = $1;
   }
   ;
@@ -87,14 +98,12 @@ FuncDefs
 // FuncDef ::= FuncType IDENT "(" [FuncFParams] ")" Block;
 FuncDef
   : FuncType IDENT '(' ')' Block {
-    if (flag) cerr << "解析 FuncDef: " << *$2 << " 无参数" << endl;
-    $$ = new FuncDefAST(unique_ptr<BaseAST>($1), *$2, nullptr, unique_ptr<BaseAST>($5));
-    delete $2;
+    if (flag) cerr << "解析 FuncDef: " << interner.str($2) << " 无参数" << endl;
+    $$ = new FuncDefAST(unique_ptr<BaseAST>($1), $2, nullptr, unique_ptr<BaseAST>($5));
   }
   | FuncType IDENT '(' FuncFParams ')' Block {
-    if (flag) cerr << "解析 FuncDef: " << *$2 << " 带有参数" << endl;
-    $$ = new FuncDefAST(unique_ptr<BaseAST>($1), *$2, unique_ptr<BaseAST>(new FuncFParamsAST(std::move(*$4))), unique_ptr<BaseAST>($6));
-    delete $2;
+    if (flag) cerr << "解析 FuncDef: " << interner.str($2) << " 带有参数" << endl;
+    $$ = new FuncDefAST(unique_ptr<BaseAST>($1), $2, unique_ptr<BaseAST>(new FuncFParamsAST(std::move(*$4))), unique_ptr<BaseAST>($6));
   }
   ;
 
@@ -114,7 +123,7 @@ FuncType
 FuncFParams
   : FuncFParam {
     if (flag) cerr << "解析 FuncFParams: 单一参数" << endl;
-    $$ = new vector<unique_ptr<BaseAST>>();
+    $$ = ast_arena.make<ASTList>();
     $$->push_back(unique_ptr<BaseAST>($1));
   }
   | FuncFParams ',' FuncFParam {
@@ -127,9 +136,8 @@ FuncFParams
 // FuncFParam ::= BType IDENT;
 FuncFParam
   : BType IDENT {
-    if (flag) cerr << "解析 FuncFParam: " << *$2 << endl;
-    $$ = new FuncFParamAST(unique_ptr<BaseAST>($1), *$2);
-    delete $2;
+    if (flag) cerr << "解析 FuncFParam: " << interner.str($2) << endl;
+    $$ = new FuncFParamAST(unique_ptr<BaseAST>($1), $2);
   }
   ;
 
@@ -143,7 +151,7 @@ Block
 BlockItemList
   : /* empty */ {
     if (flag) cerr << "Parsed BlockItemList: empty" << endl;
-    $$ = new vector<unique_ptr<BaseAST>>();
+    $$ = ast_arena.make<ASTList>();
   }
   | BlockItemList BlockItem {
     if (flag) cerr << "Parsed BlockItemList: added item, total " << $1->size() + 1 << " items" << endl;
@@ -176,14 +184,14 @@ Decl
 
 ConstDecl
   : CONST BType ConstDefList ';' {
-    if (flag) cerr << "Parsed ConstDecl: const " << dynamic_cast<BTypeAST*>($2)->type << " with " << $3->size() << " definitions" << endl;
+    if (flag) cerr << "Parsed ConstDecl: const " << cast<BTypeAST>($2)->type << " with " << $3->size() << " definitions" << endl;
     $$ = new ConstDeclAST(unique_ptr<BaseAST>($2), std::move(*$3));
   }
   ;
 
 VarDecl
   : BType VarDefList ';' {
-    if (flag) cerr << "Parsed VarDecl: " << dynamic_cast<BTypeAST*>($1)->type << " with " << $2->size() << " definitions" << endl;
+    if (flag) cerr << "Parsed VarDecl: " << cast<BTypeAST>($1)->type << " with " << $2->size() << " definitions" << endl;
     $$ = new VarDeclAST(unique_ptr<BaseAST>($1), std::move(*$2));
   }
   ;
@@ -198,7 +206,7 @@ BType
 ConstDefList
   : ConstDef {
     if (flag) cerr << "Parsed ConstDefList: single definition" << endl;
-    $$ = new vector<unique_ptr<BaseAST>>();
+    $$ = ast_arena.make<ASTList>();
     $$->push_back(unique_ptr<BaseAST>($1));
   }
   | ConstDefList ',' ConstDef {
@@ -211,7 +219,7 @@ ConstDefList
 VarDefList
   : VarDef {
     if (flag) cerr << "Parsed VarDefList: single definition" << endl;
-    $$ = new vector<unique_ptr<BaseAST>>();
+    $$ = ast_arena.make<ASTList>();
     $$->push_back(unique_ptr<BaseAST>($1));
   }
   | VarDefList ',' VarDef {
@@ -223,33 +231,33 @@ VarDefList
 
 ConstDef
   : IDENT '=' ConstInitVal {
-    if (flag) cerr << "Parsed ConstDef: " << *$1 << " = ConstInitVal" << endl;
-    $$ = new ConstDefAST(*$1, unique_ptr<BaseAST>($3));
+    if (flag) cerr << "Parsed ConstDef: " << interner.str($1) << " = ConstInitVal" << endl;
+    $$ = new ConstDefAST($1, unique_ptr<BaseAST>($3));
   }
   ;
 
 VarDef
   : IDENT {
-    if (flag) cerr << "Parsed VarDef: " << *$1 << endl;
-    $$ = new VarDefAST(*$1);
+    if (flag) cerr << "Parsed VarDef: " << interner.str($1) << endl;
+    $$ = new VarDefAST($1);
   }
   | IDENT '=' InitVal {
-    if (flag) cerr << "Parsed VarDef: " << *$1 << " = InitVal" << endl;
-    $$ = new VarDefAST(*$1, unique_ptr<BaseAST>($3));
+    if (flag) cerr << "Parsed VarDef: " << interner.str($1) << " = InitVal" << endl;
+    $$ = new VarDefAST($1, unique_ptr<BaseAST>($3));
   }
   ;
 
 ConstInitVal
   : ConstExp {
     if (flag) cerr << "Parsed ConstInitVal: ConstExp" << endl;
-    $$ = new ConstInitValAST(unique_ptr<BaseAST>($1));
+    $$ = $1;
   }
   ;
 
 InitVal
   : Exp {
     if (flag) cerr << "Parsed InitVal: Exp" << endl;
-    $$ = new InitValAST(unique_ptr<BaseAST>($1));
+    $$ = $1;
   }
   ;
 
@@ -363,127 +371,128 @@ ClosedStmt
   }
   ;
 
+// 表达式各层的单子节点产生式直接把子节点向上传递，不建包装节点：
+// 语法树里只剩 BinaryExp / UnaryOpExp / CallExp / LVal / Number
 Exp
   : LOrExp {
     if (flag) cerr << "Parsed Exp: LOrExp" << endl;
-    $$ = new ExpAST(unique_ptr<BaseAST>($1));
+    $$ = $1;
   }
   ;
 
 LOrExp
   : LAndExp {
     if (flag) cerr << "Parsed LOrExp: Single LAndExp" << endl;
-    $$ = new LOrExpAST(unique_ptr<BaseAST>($1));
+    $$ = $1;
   }
   | LOrExp OR LAndExp {
     if (flag) cerr << "Parsed LOrExp: || operation" << endl;
-    $$ = new LOrExpAST(unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::LOR, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   ;
 
 LAndExp
   : EqExp {
     if (flag) cerr << "Parsed LAndExp: Single EqExp" << endl;
-    $$ = new LAndExpAST(unique_ptr<BaseAST>($1));
+    $$ = $1;
   }
   | LAndExp AND EqExp {
     if (flag) cerr << "Parsed LAndExp: && operation" << endl;
-    $$ = new LAndExpAST(unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::LAND, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   ;
 
 EqExp
   : RelExp {
     if (flag) cerr << "Parsed EqExp: Single RelExp" << endl;
-    $$ = new EqExpAST(unique_ptr<BaseAST>($1));
+    $$ = $1;
   }
   | EqExp EQ RelExp {
     if (flag) cerr << "Parsed EqExp: == operation" << endl;
-    $$ = new EqExpAST(unique_ptr<BaseAST>($1), "==", unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::EQ, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   | EqExp NE RelExp {
     if (flag) cerr << "Parsed EqExp: != operation" << endl;
-    $$ = new EqExpAST(unique_ptr<BaseAST>($1), "!=", unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::NE, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   ;
 
 RelExp
   : AddExp {
     if (flag) cerr << "Parsed RelExp: Single AddExp" << endl;
-    $$ = new RelExpAST(unique_ptr<BaseAST>($1));
+    $$ = $1;
   }
   | RelExp LT AddExp {
     if (flag) cerr << "Parsed RelExp: < operation" << endl;
-    $$ = new RelExpAST(unique_ptr<BaseAST>($1), "<", unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::LT, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   | RelExp GT AddExp {
     if (flag) cerr << "Parsed RelExp: > operation" << endl;
-    $$ = new RelExpAST(unique_ptr<BaseAST>($1), ">", unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::GT, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   | RelExp LE AddExp {
     if (flag) cerr << "Parsed RelExp: <= operation" << endl;
-    $$ = new RelExpAST(unique_ptr<BaseAST>($1), "<=", unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::LE, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   | RelExp GE AddExp {
     if (flag) cerr << "Parsed RelExp: >= operation" << endl;
-    $$ = new RelExpAST(unique_ptr<BaseAST>($1), ">=", unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::GE, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   ;
 
 AddExp
   : MulExp {
     if (flag) cerr << "Parsed AddExp: Single MulExp" << endl;
-    $$ = new AddExpAST(unique_ptr<BaseAST>($1));
+    $$ = $1;
   }
   | AddExp '+' MulExp {
     if (flag) cerr << "Parsed AddExp: + operation" << endl;
-    $$ = new AddExpAST(unique_ptr<BaseAST>($1), "+", unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::ADD, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   | AddExp '-' MulExp {
     if (flag) cerr << "Parsed AddExp: - operation" << endl;
-    $$ = new AddExpAST(unique_ptr<BaseAST>($1), "-", unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::SUB, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   ;
 
 MulExp
   : UnaryExp {
     if (flag) cerr << "Parsed MulExp: Single UnaryExp" << endl;
-    $$ = new MulExpAST(unique_ptr<BaseAST>($1));
+    $$ = $1;
   }
   | MulExp '*' UnaryExp {
     if (flag) cerr << "Parsed MulExp: * operation" << endl;
-    $$ = new MulExpAST(unique_ptr<BaseAST>($1), "*", unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::MUL, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   | MulExp '/' UnaryExp {
     if (flag) cerr << "Parsed MulExp: / operation" << endl;
-    $$ = new MulExpAST(unique_ptr<BaseAST>($1), "/", unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::DIV, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   | MulExp '%' UnaryExp {
     if (flag) cerr << "Parsed MulExp: % operation" << endl;
-    $$ = new MulExpAST(unique_ptr<BaseAST>($1), "%", unique_ptr<BaseAST>($3));
+    $$ = new BinaryExpAST(BinaryOp::MOD, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($3));
   }
   ;
 
 PrimaryExp
   : '(' Exp ')' {
     if (flag) cerr << "Parsed PrimaryExp: (Exp)" << endl;
-    $$ = new PrimaryExpAST(unique_ptr<BaseAST>($2), nullptr, nullptr, PrimaryExpAST::EXP);
+    $$ = $2;
   }
   | LVal {
     if (flag) cerr << "Parsed PrimaryExp: LVal" << endl;
-    $$ = new PrimaryExpAST(nullptr, unique_ptr<BaseAST>($1), nullptr, PrimaryExpAST::LVAL);
+    $$ = $1;
   }
   | Number {
     if (flag) cerr << "Parsed PrimaryExp: Number" << endl;
-    $$ = new PrimaryExpAST(nullptr, nullptr, unique_ptr<BaseAST>($1), PrimaryExpAST::NUMBER);
+    $$ = $1;
   }
   ;
 
 LVal
   : IDENT {
-    if (flag) cerr << "Parsed LVal: " << *$1 << endl;
-    $$ = new LValAST(*$1);
-    delete $1;
+    if (flag) cerr << "Parsed LVal: " << interner.str($1) << endl;
+    $$ = new LValAST($1);
   }
   ;
 
@@ -491,22 +500,19 @@ LVal
 UnaryExp
   : PrimaryExp {
     if (flag) cerr << "解析 UnaryExp: PrimaryExp" << endl;
-    $$ = new UnaryExpAST(UnaryExpAST::StmtKind::PRIMARY, nullptr, nullptr, unique_ptr<BaseAST>($1));
+    $$ = $1;
   }
   | UnaryOp UnaryExp %prec UNARY_OP {
-    UnaryOpAST* unary_op = dynamic_cast<UnaryOpAST*>($1);
-    if (flag) cerr << "解析 UnaryExp: 一元运算符 " << unary_op->op << endl;
-    $$ = new UnaryExpAST(UnaryExpAST::StmtKind::UNARY_OP, unique_ptr<BaseAST>($1), unique_ptr<BaseAST>($2), nullptr);
+    if (flag) cerr << "解析 UnaryExp: 一元运算符 " << op_spelling($1) << endl;
+    $$ = new UnaryOpExpAST($1, unique_ptr<BaseAST>($2));
   }
   | IDENT '(' ')' {
-    if (flag) cerr << "解析 UnaryExp: 函数调用 " << *$1 << " 无参数" << endl;
-    $$ = new UnaryExpAST(UnaryExpAST::StmtKind::CALL, nullptr, nullptr, nullptr, *$1, nullptr);
-    delete $1;
+    if (flag) cerr << "解析 UnaryExp: 函数调用 " << interner.str($1) << " 无参数" << endl;
+    $$ = new CallExpAST($1);
   }
   | IDENT '(' FuncRParams ')' {
-    if (flag) cerr << "解析 UnaryExp: 函数调用 " << *$1 << " 有参数" << endl;
-    $$ = new UnaryExpAST(UnaryExpAST::StmtKind::CALL, nullptr, nullptr, nullptr, *$1, unique_ptr<BaseAST>(new FuncRParamsAST(std::move(*$3))));
-    delete $1;
+    if (flag) cerr << "解析 UnaryExp: 函数调用 " << interner.str($1) << " 有参数" << endl;
+    $$ = new CallExpAST($1, unique_ptr<BaseAST>(new FuncRParamsAST(std::move(*$3))));
   }
   ;
 
@@ -514,7 +520,7 @@ UnaryExp
 FuncRParams
   : Exp {
     if (flag) cerr << "解析 FuncRParams: 单一实参" << endl;
-    $$ = new vector<unique_ptr<BaseAST>>();
+    $$ = ast_arena.make<ASTList>();
     $$->push_back(unique_ptr<BaseAST>($1));
   }
   | FuncRParams ',' Exp {
@@ -527,15 +533,15 @@ FuncRParams
 UnaryOp
   : '+' {
     if (flag) cerr << "Parsed UnaryOp: +" << endl;
-    $$ = new UnaryOpAST("+");
+    $$ = UnaryOp::POS;
   }
   | '-' {
     if (flag) cerr << "Parsed UnaryOp: -" << endl;
-    $$ = new UnaryOpAST("-");
+    $$ = UnaryOp::NEG;
   }
   | '!' {
     if (flag) cerr << "Parsed UnaryOp: !" << endl;
-    $$ = new UnaryOpAST("!");
+    $$ = UnaryOp::NOT;
   }
   ;
 
@@ -549,7 +555,7 @@ Number
 ConstExp
   : Exp {
     if (flag) cerr << "Parsed ConstExp: Exp" << endl;
-    $$ = new ConstExpAST(unique_ptr<BaseAST>($1));
+    $$ = $1;
   }
   ;
 
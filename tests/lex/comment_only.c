@@ -0,0 +1 @@
+/* 只有注释 */
\ No newline at end of file
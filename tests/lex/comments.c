@@ -0,0 +1,13 @@
+// 各种注释：行注释、块注释，以及和除号相邻的情况
+/**/ /***/ /****/ /* * */ /* ** */ /*/ */ /* / */ /* // */
+/*
+ * 多行注释，里面有中文、*、/ 和 "引号"
+ ** 连续的星号 ***
+ */
+int main() { // 行末注释 /* 不会开始块注释
+    int a = 8/*紧贴*/+ 2, b = a/2, c = a / /* 中间 */ 2;
+    int d = a/ 2 /**/ /b;
+    /* 注释里的 int return 0; */ return a // 注释里的 */
+        + b + c + d;
+}
+// 文件结尾的行注释没有换行符
\ No newline at end of file
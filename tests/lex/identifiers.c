@@ -0,0 +1,8 @@
+int integer, int_, _int, Int, INT, iff, If, iF, elsewhere, else1;
+void voidp, void_, whilex, _while, returnValue, return0, breakpoint;
+int continue_, continued, constant, const_, _, __, _0, a0b1c2;
+int a_very_long_identifier_name_that_goes_on_and_on_past_sixty_four_characters_0123456789;
+int main() {
+    const int x = 1; if (x) return x; else while (0) { break; continue; }
+    return integer+int_+_int+Int+INT+iff+If+iF+elsewhere+else1+voidp;
+}
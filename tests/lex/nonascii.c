@@ -0,0 +1,4 @@
+int main() {
+    int 变量 = 1; // UTF-8 标识符不是合法的 SysY
+    return 变量 + a;
+}
@@ -0,0 +1,8 @@
+int main() {
+    int a = 0, b = 00, c = 0777, d = 012, e = 0x0, f = 0X0, g = 0xff;
+    int h = 0XaBcDeF, i = 0x7fffffff, j = 2147483647, k = 2147483648;
+    int l = 4294967295, m = 0xffffffff, n = 017777777777, o = 1234567890;
+    // 不是合法字面量的拼接：08、09、0x、123abc、0xfg
+    int p = 08, q = 09, r = 0x, s = 123abc, t = 0xfg, u = 0x1p3;
+    return -2147483648 + a+b+c+d+e+f+g+h+i+j+k+l+m+n+o+p+q+r+s+t+u;
+}
@@ -0,0 +1,11 @@
+int main() {
+    int a = 1, b = 2;
+    a = a+b-a*b/a%b; a = -a; a = +a; a = !a; a = !!a; a = - -a;
+    if (a<b && a<=b || a>b && a>=b || a==b || a!=b) a = 0;
+    // 只差一个字符的组合
+    a = a<==b; a = a>==b; a = a!==b; a = a===b; a = a=!b; a = a<>b;
+    a = a&&&b; a = a|||b; a = a&b; a = a|b; a = a&&!b; a = a||-b;
+    a = a< =b; a = a> =b; a = a= =b; a = a! =b; a = a& &b; a = a| |b;
+    int c[2][3] = {{1, 2, 3}, {}}; c[1][2] = c[0][a];
+    return a ? b : c; # $ ` ~ ^ ' " \ @
+}
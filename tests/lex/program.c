@@ -0,0 +1,22 @@
+int f(int n) {
+  int i = 0, s = 0;
+  while (i < n) {
+    int j = 0;
+    while (j < i) {
+      if (j % 3 == 1) { j = j + 1; continue; }
+      s = s + i * j - (i + j);
+      if (s > 100000) return s;
+      j = j + 1;
+    }
+    i = i + 1;
+  }
+  return s;
+}
+int main() {
+  putint(f(30)); putch(10);
+  int a = 7, b = 3;
+  int x = a * b + a * b;
+  int y = (a + 1) * (a + 1) - (1 + a);
+  putint(x + y); putch(10);
+  return 0;
+}
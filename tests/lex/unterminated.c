@@ -0,0 +1,5 @@
+int main() {
+    int a = 1; /* 没有结束的块注释
+    int b = 2;
+    return a * b;
+}
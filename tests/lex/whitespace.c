@@ -0,0 +1,9 @@
+int main() {
+	int a = 1;
+  	  return a	+
+1;
+}
+// 回车结尾
+ int b;
+
+